@@ -21,7 +21,7 @@ int main()
 	//the shader manager doesn't actually need to be initialized
 	shaders->LoadShaderProgramsFromConfigFile("Shaders/Shaders.txt", programs, true);
 
-	glUseProgram(programs[0]->handle);
+	shaders->BindProgram(programs[0]);
 	
 	glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
 	glPointSize(20.0f);
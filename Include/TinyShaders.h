@@ -7,6 +7,7 @@
 #define TS_WINDOWS
 #include <Windows.h>
 #include <gl/GL.h>
+#include <io.h>
 //disable annoying warnings about unsafe stdio functions
 #pragma  warning(disable: 4474)
 #pragma  warning(disable: 4996)
@@ -16,7 +17,27 @@
 #endif
 
 #if defined(__linux__) 
+#define TS_LINUX
 #include <GL/gl.h>
+#if !defined(TS_HEADLESS)
+#include <GL/glx.h>
+#endif
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TS_SSE2
+#include <emmintrin.h>
+#endif
+
+//define TS_HEADLESS to get headlessContext_t. it needs EGL (libEGL) to be linked
+#if defined(TS_HEADLESS)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
 #endif
 
 #include <list>
@@ -24,6 +45,7 @@
 #include <map>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -32,6 +54,15 @@
 #include <memory>
 #include <system_error>
 #include <bitset>
+#include <set>
+#include <array>
+#include <cstddef>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include <sys/stat.h>
 
 namespace TinyShaders
@@ -59,6 +90,22 @@ namespace TinyShaders
 		invalidConfigFile,
 		invalidSourceFiles,
 		invalidBuffer,
+		spirvNotSupported,
+		spirvModuleNotFound,
+		spirvModuleAlreadyExists,
+		shaderSpecializationFailed,
+		includeDepthExceeded,
+		invalidCookedManifest,
+		headlessContextFailed,
+		uniformNotFound,
+		uniformTypeMismatch,
+		uniformRingFailed,
+		uniformRingFull,
+		fileWatcherFailed,
+		pipelinesNotSupported,
+		notSeparableStage,
+		invalidProgramBinary,
+		binaryFormatNotSupported,
 	};
 
 	class errorCategory_t : public std::error_category
@@ -167,6 +214,86 @@ namespace TinyShaders
 				return "Error: invalid buffer \n";
 			}
 
+			case error_t::spirvNotSupported:
+			{
+				return "Error: SPIR-V shaders are not supported by the current context \n";
+			}
+
+			case error_t::spirvModuleNotFound:
+			{
+				return "Error: SPIR-V module not found \n";
+			}
+
+			case error_t::spirvModuleAlreadyExists:
+			{
+				return "Error: SPIR-V module already exists \n";
+			}
+
+			case error_t::shaderSpecializationFailed:
+			{
+				return "Error: shader specialization failed \n";
+			}
+
+			case error_t::includeDepthExceeded:
+			{
+				return "Error: too many nested includes \n";
+			}
+
+			case error_t::invalidCookedManifest:
+			{
+				return "Error: invalid cooked manifest \n";
+			}
+
+			case error_t::headlessContextFailed:
+			{
+				return "Error: failed to create a headless OpenGL context \n";
+			}
+
+			case error_t::uniformNotFound:
+			{
+				return "Error: uniform not found \n";
+			}
+
+			case error_t::uniformTypeMismatch:
+			{
+				return "Error: value does not match the type of the uniform \n";
+			}
+
+			case error_t::uniformRingFailed:
+			{
+				return "Error: failed to create the persistently mapped uniform buffer \n";
+			}
+
+			case error_t::uniformRingFull:
+			{
+				return "Error: the uniform ring has no room left this frame \n";
+			}
+
+			case error_t::fileWatcherFailed:
+			{
+				return "Error: failed to start watching shader files \n";
+			}
+
+			case error_t::pipelinesNotSupported:
+			{
+				return "Error: program pipeline objects are not supported by this context \n";
+			}
+
+			case error_t::notSeparableStage:
+			{
+				return "Error: pipelines can only be made of linked separable stages \n";
+			}
+
+			case error_t::invalidProgramBinary:
+			{
+				return "Error: program binary file is truncated or has a broken header \n";
+			}
+
+			case error_t::binaryFormatNotSupported:
+			{
+				return "Error: program binary was made for a format or driver this context can't load \n";
+			}
+
 			default:
 			{
 				return "Error: unspecified error \n";
@@ -201,786 +328,6514 @@ namespace TinyShaders
 	std::string defaultBinaryPath = "./Shaders/";
 	std::string defaultBinaryConfig = "Binaries.txt";
 	std::string defaultProgramPath = "Shaders.txt";
+	std::string defaultCookedExtension = ".tscooked";
+	std::string defaultBinaryCacheIndex = "BinaryCache.txt";					/**< The index of the binary cache. it lives in defaultBinaryPath */
+	unsigned int maxIncludeDepth = 16;										/**< How deep #include directives can be nested before giving up */
+	bool alwaysRetrievableBinaries = false;									/**< Link every program with the retrievable hint, even when no binary is saved. the cooker sets this */
+	bool compressBinaries = true;											/**< Compress the program binaries in .glbin files and cooked manifests. either kind can always be read */
+
+	const GLint cookedManifestVersion = 3;
+	unsigned int maxNumShaderComponents = 5;								/**< The Maximum number of stages a shader program can have. It's always 5. library shaders don't count*/
 
-	unsigned int maxNumShaderComponents = 5;								/**< The Maximum number of components a shader program can have. It's always 5*/
+	//OpenGL 4.6 / ARB_gl_spirv. not every extension loader provides these so TinyShaders fetches them itself
+	typedef void(*specializeShader_t)(GLuint shader, const GLchar* entryPoint, GLuint numSpecializationConstants, const GLuint* constantIndex, const GLuint* constantValue);
+	const GLenum gl_shader_binary_format_spir_v = 0x9551;
+	specializeShader_t glSpecializeShaderProc = nullptr;
 
-	typedef std::function<void(GLuint programHandle)>		parseBlocks_t;	/**< a callback that can gather all the info about the uniform blocks that are in a shader program*/
+	//KHR_parallel_shader_compile. lets compile and link status be polled without waiting on the driver
+	const GLenum gl_completion_status = 0x91B1;
+	GLint parallelCompileSupport = -1;										/**< -1 until the extension has been looked for */
 
 	/*
-	* a shader_t is essentially an OpenGL shader
+	* a driverInfo_t is what decides whether a program binary can be loaded on a context
 	*/
-	struct shader_t
+	struct driverInfo_t
 	{
-		shader_t(const GLchar* shaderName, GLuint shaderType, const GLchar* shaderFilePath) :
-			name(shaderName)
-		{
-			type = shaderType;
-			isCompiled = GL_FALSE;
-			filePath = shaderFilePath;
-			FileToBuffer(shaderFilePath, buffer);
+		bool					queried;		/**<Whether the context has been asked yet*/
+		std::vector<GLint>		binaryFormats;	/**<The GL_PROGRAM_BINARY_FORMATS of the context*/
+		GLuint64				hash;			/**<A hash of the vendor, renderer and version strings*/
+	};
 
-			Compile(buffer);
-		}
+	//program binaries only load on drivers that accept their format. contexts can be on different GPUs so each is asked once
+	std::map<const void*, driverInfo_t> driverInfos;						/**< Keyed by the native context that was current when they were asked for */
+	std::mutex driverInfoMutex;												/**< Guards driverInfos. contexts can be current on different threads */
 
-		shader_t(const GLchar* shaderName, std::string buffer, GLuint shaderType)
-			: name(shaderName), type(shaderType), buffer(buffer)
-		{
-			type = shaderType;
-			isCompiled = false;
-			Compile(buffer);
-			filePath = NULL;
+	/*
+	* fetch an OpenGL entry point from the driver. a context must be current
+	*/
+	template<typename T> bool LoadEntryPoint(T& funcPointer, const char* procName)
+	{
+#if defined(TS_HEADLESS)
+		funcPointer = (T)eglGetProcAddress(procName);
+#elif defined(TS_WINDOWS)
+		funcPointer = (T)wglGetProcAddress(procName);
+#elif defined(TS_LINUX)
+		funcPointer = (T)glXGetProcAddress((const GLubyte*)procName);
+#endif
+		return funcPointer != nullptr;
+	}
 
-		}
-		shader_t()
+	/*
+	* whether the driver compiles and links in the background (KHR/ARB_parallel_shader_compile). a context must be current
+	*/
+	inline bool ParallelCompileSupported()
+	{
+		if (parallelCompileSupport < 0)
 		{
-			name = NULL;
-			handle = 0;
-			type = 0;
-			isCompiled = false;;
-			filePath = NULL;
+			parallelCompileSupport = 0;
+			GLint numExtensions = 0;
+			glGetIntegerv(gl_num_extensions, &numExtensions);
+			for (GLint iterator = 0; iterator < numExtensions && glGetStringi != nullptr; iterator++)
+			{
+				const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)iterator);
+				if (extension != nullptr && (!strcmp(extension, "GL_KHR_parallel_shader_compile") || !strcmp(extension, "GL_ARB_parallel_shader_compile")))
+				{
+					parallelCompileSupport = 1;
+				}
+			}
 		}
-		~shader_t() {}
+		return parallelCompileSupport == 1;
+	}
 
-		/*
-		* compile the shader from a given text file
-		*/
-		std::error_code Compile(std::string source)
+	/*
+	* whether a shader has finished compiling or a program has finished linking. asking for the compile or link
+	* status before then waits on the driver. without parallel compile support everything counts as finished
+	*/
+	inline bool IsCompletionReady(GLuint object, bool isProgram)
+	{
+		if (!ParallelCompileSupported())
 		{
-			//if the component hasn't been compiled yet
-			if (!isCompiled)
-			{
-				GLchar errorLog[512];
-				GLint successful;
+			return true;
+		}
 
-				if (!source.empty())
-				{
-					handle = glCreateShader(type);
-					glShaderSource(handle, 1, (const GLchar**)&source, 0);
-					glCompileShader(handle);
+		GLint complete = GL_TRUE;
+		if (isProgram)
+		{
+			glGetProgramiv(object, gl_completion_status, &complete);
+		}
 
-					glGetShaderiv(handle, gl_compile_status, &successful);
-					glGetShaderInfoLog(handle, sizeof(errorLog), 0, errorLog);
+		else
+		{
+			glGetShaderiv(object, gl_completion_status, &complete);
+		}
+		return complete == GL_TRUE;
+	}
 
-					if (!successful)
-					{
-						return error_t::shaderLoadFailed;
-					}
+#if defined(TS_HEADLESS)
+	/*
+	* a headlessContext_t is an OpenGL context with no window or display behind it. it lets build servers,
+	* cache warming jobs and benchmarks compile shaders and save program binaries without X11
+	*/
+	class headlessContext_t
+	{
+	public:
 
-					else
-					{
-						isCompiled = true;
-						return error_t::success;
-					}
-				}
-				else
-				{
-					return error_t::invalidSourceFiles;
-				}
-			}
-			else
-			{
-				//the component has already been loaded
-				return error_t::shaderAlreadyCompiled;
-			}
+		headlessContext_t()
+		{
+			display = EGL_NO_DISPLAY;
+			context = EGL_NO_CONTEXT;
+			surface = EGL_NO_SURFACE;
 		}
 
-		/*
-		* remove the shader from OpenGL
-		*/
-		void Shutdown()
+		~headlessContext_t()
 		{
-			glDeleteShader(handle);
-			isCompiled = GL_FALSE;
+			Shutdown();
 		}
 
 		/*
-		* convert the given file to a single dimension c-string buffer
+		* create the context, make it current on the calling thread and load the OpenGL entry points.
+		* loadEntryPoints is whatever the application uses to load OpenGL (TinyExtender::InitializeExtentions for example)
 		*/
-		std::error_code FileToBuffer(const GLchar* path, std::string& outBuffer) const
+		std::error_code Initialize(std::function<std::error_code()> loadEntryPoints, GLint majorVersion = 4, GLint minorVersion = 5)
 		{
-			FILE* file = fopen(path, "rt");
+			//prefer Mesa's surfaceless platform so no display server is ever touched
+			PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+			if (getPlatformDisplay != nullptr)
+			{
+				display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			}
 
-			if (file == nullptr)
+			if (display == EGL_NO_DISPLAY)
 			{
-				return error_t::invalidFilePath;
+				display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 			}
 
-			struct stat fileSize;
-			size_t FileLength = 0;
+			if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr) || !eglBindAPI(EGL_OPENGL_API))
+			{
+				Shutdown();
+				return error_t::headlessContextFailed;
+			}
 
-			if (!stat(path, &fileSize))
+			const EGLint configAttributes[] =
+			{
+				EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+				EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+				EGL_NONE
+			};
+
+			EGLConfig config = nullptr;
+			EGLint numConfigs = 0;
+			if (!eglChooseConfig(display, configAttributes, &config, 1, &numConfigs) || numConfigs == 0)
 			{
-				FileLength = fileSize.st_size;
+				Shutdown();
+				return error_t::headlessContextFailed;
 			}
 
-			else
+			const EGLint contextAttributes[] =
 			{
-				return error_t::invalidFilePath;
+				EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+				EGL_CONTEXT_MINOR_VERSION, minorVersion,
+				EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+				EGL_NONE
+			};
+
+			context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+			if (context == EGL_NO_CONTEXT)
+			{
+				Shutdown();
+				return error_t::headlessContextFailed;
 			}
 
-			//get total byte in given file
-			/*fseek(file, 0, SEEK_END);
-			size_t FileLength = ftell(file);
-			fseek(file, 0, SEEK_SET);*/
+			//without surfaceless support a tiny pbuffer stands in for the missing window
+			const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+			if (extensions == nullptr || strstr(extensions, "EGL_KHR_surfaceless_context") == nullptr)
+			{
+				const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+				surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+			}
 
-			//allocate a file buffer and read the contents of the file
-			GLchar* buffer = new GLchar[FileLength + 1];
-			memset(buffer, 0, FileLength + 1);
-			fread(buffer, sizeof(GLchar), FileLength, file);
+			if (!eglMakeCurrent(display, surface, surface, context))
+			{
+				Shutdown();
+				return error_t::headlessContextFailed;
+			}
 
-			fclose(file);
-			outBuffer = buffer;
-			delete buffer;
+			if (loadEntryPoints != nullptr)
+			{
+				return loadEntryPoints();
+			}
 			return error_t::success;
 		}
 
-		const GLchar*		name;			/**<The name of the shader component */
-		const GLchar*		filePath;		/**<The FilePath of the component*/
-		GLuint				handle;			/**<The handle to the shader in OpenGL*/
-		GLuint				type;			/**<The type of shader ( Vertex, Fragment, etc.)*/
-		GLboolean			isCompiled;		/**<Whether the shader has been compiled*/
-		std::string			buffer;			/**<the source code of the shader*/
-	};
-
-	/*
-	* a shaderProgram_t is is essentially an OpengL shader program
-	*/
-	struct shaderProgram_t
-	{
-		shaderProgram_t()
-		{
-			compiled = false;
-			name = 0;
-			handle = 0;
-		};
-
 		/*
-		* uses the given values to create an OpenGL shader program
+		* release the context and the display connection
 		*/
-		shaderProgram_t(const GLchar* programName,
-			std::vector< std::string > programInputs,
-			std::vector< std::string > programOutputs,
-			std::vector< std::unique_ptr<shader_t>> programShaders,
-			bool saveBinary = false) :
-			name(programName), inputs(programInputs),
-			outputs(programOutputs), shaders(std::move(programShaders))
+		void Shutdown()
 		{
-			compiled = GL_FALSE;
-			Compile(saveBinary);
-		};
+			if (display != EGL_NO_DISPLAY)
+			{
+				eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+				if (surface != EGL_NO_SURFACE)
+				{
+					eglDestroySurface(display, surface);
+				}
+
+				if (context != EGL_NO_CONTEXT)
+				{
+					//a later context could get the same handle on another device
+					std::lock_guard<std::mutex> lock(driverInfoMutex);
+					driverInfos.erase((const void*)context);
+					eglDestroyContext(display, context);
+				}
+				eglTerminate(display);
+			}
+
+			display = EGL_NO_DISPLAY;
+			context = EGL_NO_CONTEXT;
+			surface = EGL_NO_SURFACE;
+		}
 
 		/*
-		* another bare bones constructor
+		* get an OpenGL entry point for the headless context
 		*/
-		shaderProgram_t(const GLchar* programName) : name(programName)
+		static void* GetProcAddress(const char* procName)
 		{
-			handle = 0;
-			compiled = false;
-		};
+			return (void*)eglGetProcAddress(procName);
+		}
 
-		shaderProgram_t(const GLchar* programName, GLuint programHandle) :
-			name(programName), handle(programHandle)
+		EGLDisplay			display;		/**<The EGL display the context belongs to*/
+		EGLContext			context;		/**<The OpenGL context*/
+		EGLSurface			surface;		/**<A 1x1 pbuffer. only used when surfaceless contexts aren't supported*/
+	};
+#endif
+
+	/*
+	* 64 bit FNV-1a hash. used for content hashes
+	*/
+	inline GLuint64 HashBuffer(const void* data, size_t size, GLuint64 hash = 14695981039346656037ULL)
+	{
+		const GLubyte* bytes = (const GLubyte*)data;
+		for (size_t iterator = 0; iterator < size; iterator++)
 		{
-			compiled = false;
+			hash ^= bytes[iterator];
+			hash *= 1099511628211ULL;
 		}
+		return hash;
+	}
 
-		~shaderProgram_t() {}
+	/*
+	* the native handle of the context that is current on this thread
+	*/
+	inline const void* CurrentNativeContext()
+	{
+#if defined(TS_HEADLESS)
+		return (const void*)eglGetCurrentContext();
+#elif defined(TS_WINDOWS)
+		return (const void*)wglGetCurrentContext();
+#elif defined(TS_LINUX)
+		return (const void*)glXGetCurrentContext();
+#else
+		return nullptr;
+#endif
+	}
 
-		/*
-		* shut down the shader program. delete it from OpenGL
-		*/
-		void Shutdown()
+	/*
+	* the binary formats and driver hash of the current context. asked for the first time a context is seen
+	*/
+	inline driverInfo_t CurrentDriverInfo()
+	{
+		std::lock_guard<std::mutex> lock(driverInfoMutex);
+		driverInfo_t& info = driverInfos[CurrentNativeContext()];
+		if (!info.queried)
 		{
-			glDeleteProgram(handle);
+			GLint numFormats = 0;
+			glGetIntegerv(gl_num_program_binary_formats, &numFormats);
+			info.binaryFormats.resize((size_t)std::max(numFormats, 0));
+			if (numFormats > 0)
+			{
+				glGetIntegerv(gl_program_binary_formats, info.binaryFormats.data());
+			}
 
-			//clear up all the shaders
-			for (size_t iterator = 0; iterator < shaders.size(); iterator++)
+			const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+			info.hash = HashBuffer("", 0);
+			for (size_t iterator = 0; iterator < 3; iterator++)
 			{
-				shaders[iterator]->Shutdown();
+				const GLchar* value = (const GLchar*)glGetString(strings[iterator]);
+				info.hash = (value != nullptr) ? HashBuffer(value, strlen(value) + 1, info.hash) : info.hash;
 			}
-			shaders.clear();
-			inputs.clear();
-			outputs.clear();
+			info.queried = true;
 		}
+		return info;
+	}
 
-		/*
-		* compile the OpenGL shader program with the given information
-		*/
+	/*
+	* forget what was asked of a context, for when it is destroyed and its handle could be reused by a context on
+	* another GPU. the current context is forgotten if none is given
+	*/
+	inline void ForgetDriverInfo(const void* nativeContext = nullptr)
+	{
+		std::lock_guard<std::mutex> lock(driverInfoMutex);
+		driverInfos.erase(nativeContext != nullptr ? nativeContext : CurrentNativeContext());
+	}
+
+	/*
+	* the binary formats the current context accepts
+	*/
+	inline std::vector<GLint> SupportedBinaryFormats()
+	{
+		return CurrentDriverInfo().binaryFormats;
+	}
+
+	inline bool BinaryFormatSupported(GLenum format)
+	{
+		std::vector<GLint> formats = SupportedBinaryFormats();
+		return std::find(formats.begin(), formats.end(), (GLint)format) != formats.end();
+	}
+
+	/*
+	* identifies the driver of the current context. a new driver version usually rejects the old binaries
+	*/
+	inline GLuint64 DriverHash()
+	{
+		return CurrentDriverInfo().hash;
+	}
+
+	/*
+	* the part of a binary file name that says which format and driver it is for: "<format>-<driver hash>" in hex
+	*/
+	inline std::string BinaryTag(GLenum format, GLuint64 driver)
+	{
+		GLchar tag[32] = {};
+		snprintf(tag, sizeof(tag), "%08x-%016llx", format, (unsigned long long)driver);
+		return tag;
+	}
+
+	/*
+	* read the format and driver out of a binary file name like "Name.<tag>.glbin". returns false for untagged names
+	*/
+	inline bool ParseBinaryTag(const std::string& path, GLenum& outFormat, GLuint64& outDriver)
+	{
+		const std::string& extension = defaultProrgamBinaryExtension;
+		const size_t tagLength = 25;
+		if (path.size() < extension.size() + tagLength + 1 || path.compare(path.size() - extension.size(), extension.size(), extension) != 0)
+		{
+			return false;
+		}
+
+		size_t tagStart = path.size() - extension.size() - tagLength;
+		std::string tag = path.substr(tagStart, tagLength);
+		if (path[tagStart - 1] != '.' || tag[8] != '-' || tag.find_first_not_of("0123456789abcdef-") != std::string::npos)
+		{
+			return false;
+		}
+
+		outFormat = (GLenum)strtoul(tag.substr(0, 8).c_str(), nullptr, 16);
+		outDriver = (GLuint64)strtoull(tag.substr(9).c_str(), nullptr, 16);
+		return true;
+	}
+
+	/*
+	* where the binary of a program in the given format is saved for the driver of the current context
+	*/
+	inline std::string ProgramBinaryPath(const std::string& programName, GLenum format)
+	{
+		return defaultBinaryPath + programName + "." + BinaryTag(format, DriverHash()) + defaultProrgamBinaryExtension;
+	}
+
+	/*
+	* the same hash as HashBuffer over the characters of a name. being constexpr lets callers
+	* hash uniform names at compile time, e.g. program->GetUniformLocation(HashName("modelView"))
+	*/
+	constexpr GLuint64 HashName(const GLchar* name, GLuint64 hash = 14695981039346656037ULL)
+	{
+		return (*name == '\0') ? hash : HashName(name + 1, (hash ^ (GLubyte)*name) * 1099511628211ULL);
+	}
+
+	/*
+	* read one line from a file without the trailing newline
+	*/
+	inline bool ReadLine(FILE* file, std::string& outLine)
+	{
+		outLine.clear();
+		int character = fgetc(file);
+		if (character == EOF)
+		{
+			return false;
+		}
+
+		while (character != EOF && character != '\n')
+		{
+			if (character != '\r')
+			{
+				outLine += (char)character;
+			}
+			character = fgetc(file);
+		}
+		return true;
+	}
+
+	/*
+	* an embeddedFile_t is a file that was compiled into the executable by tinyshaders_embed (cmake/TinyShadersEmbed.cmake).
+	* the generated table spells out this same struct, so keep the two in step
+	*/
+	struct embeddedFile_t
+	{
+		const char*				path;		/**<The path the file is looked up by, relative to the working directory*/
+		const unsigned char*	data;		/**<The contents of the file. always followed by a zero byte*/
+		size_t					size;		/**<The size of the file without the zero byte*/
+	};
+
+	std::map<std::string, embeddedFile_t> embeddedFiles;					/**< Every embedded file, keyed by normalized path. searched before the file system*/
+
+//tinyshaders_embed defines TS_EMBEDDED_TABLE as the name of the generated table. the shader manager registers it
+#if defined(TS_EMBEDDED_TABLE)
+	extern const embeddedFile_t TS_EMBEDDED_TABLE[];
+#endif
+
+	/*
+	* tidy a path up so "./Shaders/../Shaders/a.glsl" and "Shaders\\a.glsl" find the same embedded file
+	*/
+	inline std::string NormalizePath(const std::string& path)
+	{
+		std::string source = path;
+		std::replace(source.begin(), source.end(), '\\', '/');
+
+		std::vector<std::string> parts;
+		std::string part;
+		std::istringstream stream(source);
+		while (std::getline(stream, part, '/'))
+		{
+			if (part == "." || (part.empty() && !parts.empty()))
+			{
+				continue;
+			}
+
+			if (part == ".." && !parts.empty() && parts.back() != ".." && !parts.back().empty())
+			{
+				parts.pop_back();
+				continue;
+			}
+			parts.push_back(part);
+		}
+
+		std::string normalized;
+		for (size_t iterator = 0; iterator < parts.size(); iterator++)
+		{
+			normalized += (iterator > 0) ? "/" : "";
+			normalized += parts[iterator];
+		}
+		return normalized;
+	}
+
+	/*
+	* add a table of embedded files. the table ends with an entry that has a null path
+	*/
+	inline void RegisterEmbeddedFiles(const embeddedFile_t* files)
+	{
+		for (; files != nullptr && files->path != nullptr; files++)
+		{
+			embeddedFiles[NormalizePath(files->path)] = *files;
+		}
+	}
+
+	/*
+	* get an embedded file by path. returns nullptr if nothing was embedded under that path
+	*/
+	inline const embeddedFile_t* FindEmbeddedFile(const char* path)
+	{
+		if (embeddedFiles.empty() || path == nullptr)
+		{
+			return nullptr;
+		}
+
+		auto file = embeddedFiles.find(NormalizePath(path));
+		return (file != embeddedFiles.end()) ? &file->second : nullptr;
+	}
+
+	/*
+	* open a file for reading, preferring an embedded copy so embedded builds never touch the disk
+	*/
+	inline FILE* OpenFile(const char* path, const char* mode)
+	{
+		const embeddedFile_t* embedded = (mode[0] == 'r' && strchr(mode, '+') == nullptr) ? FindEmbeddedFile(path) : nullptr;
+		if (embedded == nullptr)
+		{
+			return fopen(path, mode);
+		}
+
+#if defined(TS_WINDOWS)
+		//no fmemopen on windows so the contents go through an anonymous temporary file
+		FILE* file = tmpfile();
+		if (file != nullptr)
+		{
+			fwrite(embedded->data, 1, embedded->size, file);
+			rewind(file);
+		}
+		return file;
+#else
+		return fmemopen((void*)embedded->data, embedded->size, "rb");
+#endif
+	}
+
+	/*
+	* get the size of a file, embedded or on disk
+	*/
+	inline bool GetFileSize(const char* path, size_t& outSize)
+	{
+		const embeddedFile_t* embedded = FindEmbeddedFile(path);
+		if (embedded != nullptr)
+		{
+			outSize = embedded->size;
+			return true;
+		}
+
+		struct stat fileStats;
+		if (stat(path, &fileStats))
+		{
+			return false;
+		}
+		outSize = (size_t)fileStats.st_size;
+		return true;
+	}
+
+	/*
+	* the built-in codec is the LZ4 block format: runs of literals and (offset, length) matches into the last 64KB.
+	* streams are cut into independent chunks so they can be decoded a chunk at a time while they are read
+	*/
+	const size_t compressedChunkSize = 65536;
+	const GLuint storedChunkFlag = 0x80000000;								/**< Set in a chunk header when the chunk didn't shrink and is stored as is */
+
+	inline void AppendLength(size_t length, std::vector<GLubyte>& out)
+	{
+		for (; length >= 255; length -= 255)
+		{
+			out.push_back(255);
+		}
+		out.push_back((GLubyte)length);
+	}
+
+	inline void AppendSequence(const GLubyte* literals, size_t numLiterals, size_t offset, size_t matchLength, std::vector<GLubyte>& out)
+	{
+		size_t extraMatch = (matchLength >= 4) ? matchLength - 4 : 0;
+		out.push_back((GLubyte)((std::min<size_t>(numLiterals, 15) << 4) | ((matchLength >= 4) ? std::min<size_t>(extraMatch, 15) : 0)));
+		if (numLiterals >= 15)
+		{
+			AppendLength(numLiterals - 15, out);
+		}
+		out.insert(out.end(), literals, literals + numLiterals);
+
+		//the last sequence of a block is literals only
+		if (matchLength >= 4)
+		{
+			out.push_back((GLubyte)(offset & 0xFF));
+			out.push_back((GLubyte)(offset >> 8));
+			if (extraMatch >= 15)
+			{
+				AppendLength(extraMatch - 15, out);
+			}
+		}
+	}
+
+	/*
+	* compress a block. greedy matching through a 4096 entry hash table, which is plenty for program binaries
+	*/
+	inline void CompressBlock(const GLubyte* source, size_t size, std::vector<GLubyte>& out)
+	{
+		out.clear();
+		std::vector<GLuint> table(4096, 0);
+		size_t anchor = 0;
+		size_t position = 0;
+
+		//the format wants the last 5 bytes as literals and no match starting in the last 12
+		while (size > 12 && position < size - 12)
+		{
+			GLuint sequence = 0;
+			memcpy(&sequence, source + position, 4);
+			GLuint hash = (sequence * 2654435761U) >> 20;
+			size_t candidate = table[hash];
+			table[hash] = (GLuint)position + 1;
+
+			if (candidate == 0 || position - (candidate - 1) > 65535 || memcmp(source + candidate - 1, source + position, 4) != 0)
+			{
+				position++;
+				continue;
+			}
+
+			size_t match = candidate - 1;
+			size_t length = 4;
+			while (position + length < size - 5 && source[match + length] == source[position + length])
+			{
+				length++;
+			}
+
+			AppendSequence(source + anchor, position - anchor, position - match, length, out);
+			position += length;
+			anchor = position;
+		}
+		AppendSequence(source + anchor, size - anchor, 0, 0, out);
+	}
+
+	/*
+	* decompress a block into exactly size bytes. every read and write is bounds checked so a damaged file fails
+	* instead of crashing
+	*/
+	inline bool DecompressBlock(const GLubyte* source, size_t sourceSize, GLubyte* out, size_t size)
+	{
+		size_t in = 0;
+		size_t written = 0;
+		while (in < sourceSize)
+		{
+			GLubyte token = source[in++];
+			size_t numLiterals = token >> 4;
+			for (GLubyte extra = 255; numLiterals >= 15 && extra == 255; numLiterals += extra)
+			{
+				if (in >= sourceSize)
+				{
+					return false;
+				}
+				extra = source[in++];
+			}
+
+			if (numLiterals > sourceSize - in || numLiterals > size - written)
+			{
+				return false;
+			}
+			memcpy(out + written, source + in, numLiterals);
+			in += numLiterals;
+			written += numLiterals;
+
+			if (in == sourceSize)
+			{
+				break;
+			}
+
+			if (sourceSize - in < 2)
+			{
+				return false;
+			}
+			size_t offset = source[in] | (source[in + 1] << 8);
+			in += 2;
+
+			size_t length = token & 15;
+			for (GLubyte extra = 255; length >= 15 && extra == 255; length += extra)
+			{
+				if (in >= sourceSize)
+				{
+					return false;
+				}
+				extra = source[in++];
+			}
+			length += 4;
+
+			if (offset == 0 || offset > written || length > size - written)
+			{
+				return false;
+			}
+
+			//matches can overlap what they write, so copy a byte at a time
+			for (size_t iterator = 0; iterator < length; iterator++, written++)
+			{
+				out[written] = out[written - offset];
+			}
+		}
+		return written == size;
+	}
+
+	/*
+	* write size bytes to a file as a stream of compressed chunks, each with a 4 byte little endian header
+	*/
+	inline bool WriteCompressed(FILE* file, const void* data, size_t size)
+	{
+		std::vector<GLubyte> compressed;
+		const GLubyte* bytes = (const GLubyte*)data;
+		for (size_t offset = 0; offset < size; offset += compressedChunkSize)
+		{
+			size_t chunkSize = std::min(compressedChunkSize, size - offset);
+			CompressBlock(bytes + offset, chunkSize, compressed);
+
+			bool stored = compressed.size() >= chunkSize;
+			GLuint header = stored ? ((GLuint)chunkSize | storedChunkFlag) : (GLuint)compressed.size();
+			GLubyte headerBytes[4] = { (GLubyte)header, (GLubyte)(header >> 8), (GLubyte)(header >> 16), (GLubyte)(header >> 24) };
+			if (fwrite(headerBytes, 4, 1, file) != 1 ||
+				fwrite(stored ? bytes + offset : compressed.data(), stored ? chunkSize : compressed.size(), 1, file) != 1)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+	* read a stream written by WriteCompressed into size bytes. only one compressed chunk is held at a time
+	*/
+	inline bool ReadCompressed(FILE* file, void* out, size_t size)
+	{
+		std::vector<GLubyte> compressed;
+		GLubyte* bytes = (GLubyte*)out;
+		for (size_t offset = 0; offset < size; offset += compressedChunkSize)
+		{
+			size_t chunkSize = std::min(compressedChunkSize, size - offset);
+			GLubyte headerBytes[4] = {};
+			if (fread(headerBytes, 4, 1, file) != 1)
+			{
+				return false;
+			}
+
+			GLuint header = headerBytes[0] | (headerBytes[1] << 8) | (headerBytes[2] << 16) | ((GLuint)headerBytes[3] << 24);
+			if (header & storedChunkFlag)
+			{
+				if ((header & ~storedChunkFlag) != chunkSize || fread(bytes + offset, chunkSize, 1, file) != 1)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			//a compressed chunk is always smaller than the chunk it holds. checked before anything is allocated
+			if (header == 0 || header >= chunkSize)
+			{
+				return false;
+			}
+
+			compressed.resize(header);
+			if (fread(compressed.data(), header, 1, file) != 1 || !DecompressBlock(compressed.data(), header, bytes + offset, chunkSize))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+	* read what follows a payload size: a newline for raw bytes or " lz4" and a newline for a compressed stream
+	*/
+	inline bool ReadPayloadCodec(FILE* file, bool& outCompressed)
+	{
+		int next = fgetc(file);
+		outCompressed = false;
+		if (next == '\n')
+		{
+			return true;
+		}
+
+		GLchar codec[16] = {};
+		outCompressed = true;
+		return next == ' ' && fscanf(file, "%15[^\n]", codec) == 1 && strcmp(codec, "lz4") == 0 && fgetc(file) == '\n';
+	}
+
+	/*
+	* whether a payload of size bytes can come from what is left of the file. a compressed stream can't decode to
+	* more than 255 times its own size. lets a size from a damaged header be refused before it is allocated
+	*/
+	inline bool PayloadFits(FILE* file, size_t size, bool compressed)
+	{
+		long position = ftell(file);
+		if (position < 0 || fseek(file, 0, SEEK_END))
+		{
+			return false;
+		}
+
+		long end = ftell(file);
+		if (end < position || fseek(file, position, SEEK_SET))
+		{
+			return false;
+		}
+
+		size_t remaining = (size_t)(end - position);
+		return compressed ? (size / 255) <= remaining : size <= remaining;
+	}
+
+	/*
+	* a sourceChunk_t records which file a run of lines in a resolved shader source came from
+	*/
+	struct sourceChunk_t
+	{
+		std::string			filePath;		/**<The file the lines came from. empty if the shader was made from a buffer*/
+		GLuint				sourceLine;		/**<The first line of the chunk in the resolved source (1 based)*/
+		GLuint				fileLine;		/**<The first line of the chunk in the original file (1 based)*/
+		GLuint				lineCount;		/**<How many lines the chunk covers*/
+	};
+
+	enum class severity_t
+	{
+		info,
+		warning,
+		error,
+	};
+
+	/*
+	* a diagnostic_t is one message from a compile or link log, mapped back to the file it came from
+	*/
+	struct diagnostic_t
+	{
+		std::string			file;			/**<The file the message refers to. the shader or program name if there is no file*/
+		GLint				line;			/**<The line in that file. 0 if the message has no line*/
+		severity_t			severity;		/**<How bad it is*/
+		std::string			message;		/**<The message from the driver*/
+	};
+
+	/*
+	* split a driver info log into diagnostics. understands the Mesa "0:12(5): error:", NVIDIA "0(12) : error"
+	* and AMD/Intel "ERROR: 0:12:" styles. line numbers are mapped through the chunk table when one is given
+	*/
+	inline void ParseInfoLog(const std::string& log, const std::vector<sourceChunk_t>* chunks, const GLchar* defaultFile, std::vector<diagnostic_t>& outDiagnostics)
+	{
+		std::istringstream lines(log);
+		std::string line;
+
+		while (std::getline(lines, line))
+		{
+			if (line.find_first_not_of(" \t\r") == std::string::npos)
+			{
+				continue;
+			}
+
+			diagnostic_t diagnostic = { defaultFile != nullptr ? defaultFile : "", 0, severity_t::error, line };
+			GLuint sourceString = 0, sourceLine = 0, column = 0;
+			int consumed = 0;
+			std::string remainder;
+
+			if (sscanf(line.c_str(), "%u:%u(%u): %n", &sourceString, &sourceLine, &column, &consumed) == 3 && consumed > 0)
+			{
+				remainder = line.substr((size_t)consumed);
+			}
+
+			else if (sscanf(line.c_str(), "%u(%u) : %n", &sourceString, &sourceLine, &consumed) == 2 && consumed > 0)
+			{
+				remainder = line.substr((size_t)consumed);
+			}
+
+			else if ((!line.compare(0, 7, "ERROR: ") || !line.compare(0, 9, "WARNING: ")) &&
+				sscanf(line.c_str() + line.find(' ') + 1, "%u:%u: %n", &sourceString, &sourceLine, &consumed) == 2 && consumed > 0)
+			{
+				remainder = std::string(line, 0, line.find(' ')) + " " + line.substr(line.find(' ') + 1 + (size_t)consumed);
+			}
+
+			if (!remainder.empty())
+			{
+				diagnostic.line = (GLint)sourceLine;
+				diagnostic.message = remainder;
+			}
+
+			//work out the severity from the first word of the message then drop the word
+			std::string lowered = diagnostic.message.substr(0, 8);
+			std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+			size_t wordLength = 0;
+			if (!lowered.compare(0, 7, "warning"))
+			{
+				diagnostic.severity = severity_t::warning;
+				wordLength = 7;
+			}
+
+			else if (!lowered.compare(0, 4, "info") || !lowered.compare(0, 4, "note"))
+			{
+				diagnostic.severity = severity_t::info;
+				wordLength = 4;
+			}
+
+			else if (!lowered.compare(0, 5, "error"))
+			{
+				wordLength = 5;
+			}
+
+			if (wordLength > 0)
+			{
+				size_t messageStart = diagnostic.message.find_first_not_of(": \t", wordLength);
+				diagnostic.message = (messageStart == std::string::npos) ? "" : diagnostic.message.substr(messageStart);
+			}
+
+			//map the line in the resolved source back to the file it came from
+			if (chunks != nullptr && diagnostic.line > 0)
+			{
+				for (size_t iterator = 0; iterator < chunks->size(); iterator++)
+				{
+					const sourceChunk_t& chunk = (*chunks)[iterator];
+					if ((GLuint)diagnostic.line >= chunk.sourceLine && (GLuint)diagnostic.line < chunk.sourceLine + chunk.lineCount)
+					{
+						if (!chunk.filePath.empty())
+						{
+							diagnostic.file = chunk.filePath;
+						}
+						diagnostic.line = (GLint)(chunk.fileLine + ((GLuint)diagnostic.line - chunk.sourceLine));
+						break;
+					}
+				}
+			}
+
+			outDiagnostics.push_back(diagnostic);
+		}
+	}
+
+	/*
+	* print diagnostics one per line as "file:line: severity: message", the way compilers do. returns how many are errors
+	*/
+	inline GLint PrintDiagnostics(const std::vector<diagnostic_t>& diagnostics, FILE* file = stdout)
+	{
+		const char* severities[] = { "info", "warning", "error" };
+		GLint numErrors = 0;
+		for (size_t iterator = 0; iterator < diagnostics.size(); iterator++)
+		{
+			const diagnostic_t& diagnostic = diagnostics[iterator];
+			fprintf(file, "%s:%i: %s: %s\n", diagnostic.file.c_str(), diagnostic.line, severities[(int)diagnostic.severity], diagnostic.message.c_str());
+			numErrors += (diagnostic.severity == severity_t::error) ? 1 : 0;
+		}
+		return numErrors;
+	}
+
+	/*
+	* a memoryReport_t says how much memory was given back by running lean
+	*/
+	struct memoryReport_t
+	{
+		size_t				shaderObjectsDeleted;	/**<How many OpenGL shader objects were deleted after their programs linked*/
+		size_t				sourceBytesReleased;	/**<How many bytes of shader source were let go of*/
+	};
+
+	/*
+	* a single specialization constant. index is the SPIR-V SpecId of the constant
+	*/
+	struct specializationConstant_t
+	{
+		GLuint				index;			/**<The SpecId of the constant in the SPIR-V module*/
+		GLuint				value;			/**<The bit pattern of the constant value*/
+	};
+
+	/*
+	* a shader_t is essentially an OpenGL shader
+	*/
+	struct shader_t
+	{
+		shader_t(const GLchar* shaderName, GLuint shaderType, const GLchar* shaderFilePath) :
+			name(shaderName)
+		{
+			type = shaderType;
+			handle = 0;
+			pendingHandle = 0;
+			isLibrary = false;
+			isCompiled = GL_FALSE;
+			filePath = shaderFilePath;
+			ResolveIncludes(shaderFilePath, buffer, chunks);
+			contentHash = HashBuffer(buffer.data(), buffer.size());
+
+			Compile(buffer);
+		}
+
+		shader_t(const GLchar* shaderName, std::string buffer, GLuint shaderType)
+			: name(shaderName), type(shaderType), buffer(buffer)
+		{
+			type = shaderType;
+			handle = 0;
+			pendingHandle = 0;
+			isLibrary = false;
+			isCompiled = false;
+			filePath = NULL;
+			contentHash = HashBuffer(buffer.data(), buffer.size());
+			chunks.push_back({ "", 1, 1, (GLuint)std::count(buffer.begin(), buffer.end(), '\n') + 1 });
+			Compile(buffer);
+
+		}
+		/*
+		* set up a shader for a SPIR-V module and the given constants. the name is copied into the shader.
+		* Specialize creates the OpenGL shader so its error can be returned
+		*/
+		shader_t(const GLchar* shaderName, GLuint shaderType, const std::vector<GLubyte>& binary,
+			const std::vector<specializationConstant_t>& constants) :
+			ownName(shaderName)
+		{
+			name = ownName.c_str();
+			type = shaderType;
+			handle = 0;
+			pendingHandle = 0;
+			isLibrary = false;
+			isCompiled = GL_FALSE;
+			filePath = NULL;
+			contentHash = HashBuffer(binary.data(), binary.size());
+			for (size_t iterator = 0; iterator < constants.size(); iterator++)
+			{
+				contentHash = HashBuffer(&constants[iterator], sizeof(specializationConstant_t), contentHash);
+			}
+		}
+
+		shader_t()
+		{
+			name = NULL;
+			handle = 0;
+			pendingHandle = 0;
+			isLibrary = false;
+			type = 0;
+			isCompiled = false;;
+			filePath = NULL;
+			contentHash = 0;
+		}
+		~shader_t() {}
+
+		/*
+		* compile the shader from a given text file
+		*/
+		std::error_code Compile(std::string source)
+		{
+			//if the component hasn't been compiled yet
+			if (!isCompiled)
+			{
+				GLint successful;
+
+				if (!source.empty())
+				{
+					const GLchar* sourceText = source.c_str();
+					handle = glCreateShader(type);
+					glShaderSource(handle, 1, &sourceText, 0);
+					glCompileShader(handle);
+
+					//the info log is only fetched when something went wrong
+					glGetShaderiv(handle, gl_compile_status, &successful);
+
+					if (!successful)
+					{
+						GetDiagnostics(diagnostics);
+						return error_t::shaderLoadFailed;
+					}
+
+					else
+					{
+						isCompiled = true;
+						return error_t::success;
+					}
+				}
+				else
+				{
+					return error_t::invalidSourceFiles;
+				}
+			}
+			else
+			{
+				//the component has already been loaded
+				return error_t::shaderAlreadyCompiled;
+			}
+		}
+
+		/*
+		* create the shader from a SPIR-V binary and specialize it. the binary is not kept by the shader
+		*/
+		std::error_code Specialize(const std::vector<GLubyte>& binary, const GLchar* entryPoint, const std::vector<specializationConstant_t>& constants)
+		{
+			if (isCompiled)
+			{
+				return error_t::shaderAlreadyCompiled;
+			}
+
+			if (binary.empty())
+			{
+				return error_t::invalidBuffer;
+			}
+
+			if (glSpecializeShaderProc == nullptr && !LoadEntryPoint(glSpecializeShaderProc, "glSpecializeShader"))
+			{
+				return error_t::spirvNotSupported;
+			}
+
+			std::vector<GLuint> indices, values;
+			for (size_t iterator = 0; iterator < constants.size(); iterator++)
+			{
+				indices.push_back(constants[iterator].index);
+				values.push_back(constants[iterator].value);
+			}
+
+			GLint successful = GL_FALSE;
+			handle = glCreateShader(type);
+			glShaderBinary(1, &handle, gl_shader_binary_format_spir_v, binary.data(), (GLsizei)binary.size());
+			glSpecializeShaderProc(handle, entryPoint, (GLuint)constants.size(), indices.data(), values.data());
+			glGetShaderiv(handle, gl_compile_status, &successful);
+
+			if (!successful)
+			{
+				GetDiagnostics(diagnostics);
+				return error_t::shaderSpecializationFailed;
+			}
+
+			isCompiled = true;
+			return error_t::success;
+		}
+
+		/*
+		* delete the OpenGL shader and let go of the source when it can be read from the file again.
+		* returns how many bytes of source were let go of
+		*/
+		size_t Release()
+		{
+			Shutdown();
+			if (filePath == NULL)
+			{
+				return 0;
+			}
+
+			size_t released = buffer.capacity();
+			std::string().swap(buffer);
+			return released;
+		}
+
+		/*
+		* bring back a shader that was released so a new program can use it
+		*/
+		std::error_code Restore()
+		{
+			if (isCompiled)
+			{
+				return error_t::success;
+			}
+
+			if (buffer.empty() && filePath != NULL)
+			{
+				chunks.clear();
+				std::error_code result = ResolveIncludes(filePath, buffer, chunks);
+				if (result)
+				{
+					return result;
+				}
+			}
+			return Compile(buffer);
+		}
+
+		/*
+		* compile a new version of the shader from a fresh source. the old OpenGL shader is only replaced if the
+		* new one compiles, so programs can keep using the last good version of a broken edit
+		*/
+		std::error_code Reload(std::string source, std::vector<sourceChunk_t> sourceChunks)
+		{
+			std::error_code result = BeginReload(std::move(source), std::move(sourceChunks));
+			return result ? result : FinishReload();
+		}
+
+		/*
+		* start compiling a new version of the shader next to the current one. the driver may compile it in the
+		* background, see IsReloadReady. starting again drops the version that was compiling
+		*/
+		std::error_code BeginReload(std::string source, std::vector<sourceChunk_t> sourceChunks)
+		{
+			CancelReload();
+			if (source.empty())
+			{
+				return error_t::invalidSourceFiles;
+			}
+
+			const GLchar* sourceText = source.c_str();
+			pendingHandle = glCreateShader(type);
+			glShaderSource(pendingHandle, 1, &sourceText, 0);
+			glCompileShader(pendingHandle);
+			pendingBuffer.swap(source);
+			pendingChunks.swap(sourceChunks);
+			return error_t::success;
+		}
+
+		/*
+		* whether FinishReload can be called without waiting on the driver
+		*/
+		bool IsReloadReady() const
+		{
+			return pendingHandle == 0 || IsCompletionReady(pendingHandle, false);
+		}
+
+		/*
+		* replace the shader with the new version if it compiled. if it didn't, the current version stays and
+		* diagnostics has the compile log
+		*/
+		std::error_code FinishReload()
+		{
+			if (pendingHandle == 0)
+			{
+				return error_t::success;
+			}
+
+			GLint successful = GL_FALSE;
+			glGetShaderiv(pendingHandle, gl_compile_status, &successful);
+			diagnostics.clear();
+			if (!successful)
+			{
+				GetDiagnostics(pendingHandle, pendingChunks, diagnostics);
+				CancelReload();
+				return error_t::shaderLoadFailed;
+			}
+
+			if (handle != 0)
+			{
+				glDeleteShader(handle);
+			}
+
+			handle = pendingHandle;
+			pendingHandle = 0;
+			isCompiled = true;
+			buffer.swap(pendingBuffer);
+			chunks.swap(pendingChunks);
+			std::string().swap(pendingBuffer);
+			pendingChunks.clear();
+			contentHash = HashBuffer(buffer.data(), buffer.size());
+			return error_t::success;
+		}
+
+		/*
+		* drop the version that is still compiling, if there is one
+		*/
+		void CancelReload()
+		{
+			if (pendingHandle != 0)
+			{
+				glDeleteShader(pendingHandle);
+				pendingHandle = 0;
+			}
+			std::string().swap(pendingBuffer);
+			pendingChunks.clear();
+		}
+
+		/*
+		* fetch the whole compile log of the shader and turn it into diagnostics
+		*/
+		void GetDiagnostics(std::vector<diagnostic_t>& outDiagnostics) const
+		{
+			GetDiagnostics(handle, chunks, outDiagnostics);
+		}
+
+		/*
+		* fetch the compile log of the given version of the shader, mapped through its chunk table
+		*/
+		void GetDiagnostics(GLuint shaderHandle, const std::vector<sourceChunk_t>& sourceChunks, std::vector<diagnostic_t>& outDiagnostics) const
+		{
+			GLint logLength = 0;
+			if (shaderHandle != 0)
+			{
+				glGetShaderiv(shaderHandle, gl_info_log_length, &logLength);
+			}
+
+			if (logLength > 1)
+			{
+				std::vector<GLchar> log((size_t)logLength);
+				glGetShaderInfoLog(shaderHandle, logLength, nullptr, log.data());
+				ParseInfoLog(log.data(), &sourceChunks, name, outDiagnostics);
+			}
+		}
+
+		/*
+		* remove the shader from OpenGL. safe to call more than once since shaders can be shared by several owners
+		*/
+		void Shutdown()
+		{
+			CancelReload();
+			if (handle != 0)
+			{
+				glDeleteShader(handle);
+				handle = 0;
+			}
+			isCompiled = GL_FALSE;
+		}
+
+		/*
+		* convert the given file to a single dimension c-string buffer
+		*/
+		std::error_code FileToBuffer(const GLchar* path, std::string& outBuffer) const
+		{
+			FILE* file = OpenFile(path, "rt");
+
+			if (file == nullptr)
+			{
+				return error_t::invalidFilePath;
+			}
+
+			size_t FileLength = 0;
+
+			if (!GetFileSize(path, FileLength))
+			{
+				fclose(file);
+				return error_t::invalidFilePath;
+			}
+
+			//get total byte in given file
+			/*fseek(file, 0, SEEK_END);
+			size_t FileLength = ftell(file);
+			fseek(file, 0, SEEK_SET);*/
+
+			//allocate a file buffer and read the contents of the file
+			GLchar* buffer = new GLchar[FileLength + 1];
+			memset(buffer, 0, FileLength + 1);
+			fread(buffer, sizeof(GLchar), FileLength, file);
+
+			fclose(file);
+			outBuffer = buffer;
+			delete buffer;
+			return error_t::success;
+		}
+
+		/*
+		* read the given file and paste the contents of every #include "file" line in its place.
+		* includes are relative to the including file. the chunk table records where every line came from
+		*/
+		std::error_code ResolveIncludes(const GLchar* path, std::string& outSource, std::vector<sourceChunk_t>& outChunks, GLuint depth = 0) const
+		{
+			if (depth > maxIncludeDepth)
+			{
+				return error_t::includeDepthExceeded;
+			}
+
+			std::string fileBuffer;
+			std::error_code result = FileToBuffer(path, fileBuffer);
+			if (result)
+			{
+				return result;
+			}
+
+			std::string directory = path;
+			size_t lastSlash = directory.find_last_of("/\\");
+			directory = (lastSlash == std::string::npos) ? "" : directory.substr(0, lastSlash + 1);
+
+			std::istringstream lines(fileBuffer);
+			std::string line, includePath;
+			GLuint fileLine = 0;
+			sourceChunk_t chunk = { path, NextSourceLine(outChunks), 1, 0 };
+
+			while (std::getline(lines, line))
+			{
+				fileLine++;
+				if (ParseInclude(line, includePath))
+				{
+					if (chunk.lineCount > 0)
+					{
+						outChunks.push_back(chunk);
+					}
+
+					result = ResolveIncludes((directory + includePath).c_str(), outSource, outChunks, depth + 1);
+					if (result)
+					{
+						return result;
+					}
+
+					chunk.sourceLine = NextSourceLine(outChunks);
+					chunk.fileLine = fileLine + 1;
+					chunk.lineCount = 0;
+					continue;
+				}
+
+				outSource += line;
+				outSource += '\n';
+				chunk.lineCount++;
+			}
+
+			if (chunk.lineCount > 0)
+			{
+				outChunks.push_back(chunk);
+			}
+			return error_t::success;
+		}
+
+		/*
+		* check if the given line is an include directive and get the path out of it
+		*/
+		static bool ParseInclude(const std::string& line, std::string& outPath)
+		{
+			size_t start = line.find_first_not_of(" \t");
+			if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+			{
+				return false;
+			}
+
+			size_t open = line.find_first_of("\"<", start + 8);
+			if (open == std::string::npos)
+			{
+				return false;
+			}
+
+			size_t close = line.find_first_of("\">", open + 1);
+			if (close == std::string::npos)
+			{
+				return false;
+			}
+
+			outPath = line.substr(open + 1, close - open - 1);
+			return true;
+		}
+
+		/*
+		* the line in the resolved source that the next chunk will start on
+		*/
+		static GLuint NextSourceLine(const std::vector<sourceChunk_t>& chunks)
+		{
+			return chunks.empty() ? 1 : chunks.back().sourceLine + chunks.back().lineCount;
+		}
+
+		const GLchar*		name;			/**<The name of the shader component */
+		const GLchar*		filePath;		/**<The FilePath of the component*/
+		GLuint				handle;			/**<The handle to the shader in OpenGL*/
+		GLuint				type;			/**<The type of shader ( Vertex, Fragment, etc.)*/
+		GLboolean			isCompiled;		/**<Whether the shader has been compiled*/
+		std::string			buffer;			/**<the source code of the shader*/
+		GLuint64			contentHash;	/**<The hash of the source code (or SPIR-V binary and constants) of the shader*/
+		std::vector<sourceChunk_t>	chunks;	/**<Where each part of buffer came from when includes were resolved*/
+		std::vector<diagnostic_t>	diagnostics;	/**<The compile log of the shader. only filled in when compiling fails*/
+		GLuint				pendingHandle;	/**<A new version of the shader that is still compiling. 0 if there isn't one*/
+		std::string			pendingBuffer;	/**<The source of the new version*/
+		std::vector<sourceChunk_t>	pendingChunks;	/**<The chunk table of the new version*/
+		bool				isLibrary;		/**<Whether the shader only holds functions for other shaders of its stage and has no main*/
+		std::string			ownName;		/**<The storage name points at when the shader owns its name. empty when the name is borrowed*/
+	};
+
+	/*
+	* a spirvModule_t is a SPIR-V binary that is read once and specialized into any number of shader variants
+	*/
+	struct spirvModule_t
+	{
+		typedef std::vector<GLuint>		variantKey_t;	/**< the sorted index/value pairs of a variant, flattened */
+
+		spirvModule_t(const GLchar* moduleName, GLuint moduleType, const GLchar* moduleFilePath, const GLchar* moduleEntryPoint = "main") :
+			name(moduleName), filePath(moduleFilePath), entryPoint(moduleEntryPoint)
+		{
+			type = moduleType;
+		}
+
+		~spirvModule_t() {}
+
+		/*
+		* read the SPIR-V binary from disk. this only happens once no matter how many variants are made
+		*/
+		std::error_code Load()
+		{
+			FILE* file = OpenFile(filePath.c_str(), "rb");
+
+			if (file == nullptr)
+			{
+				return error_t::invalidFilePath;
+			}
+
+			size_t fileSize = 0;
+			if (!GetFileSize(filePath.c_str(), fileSize))
+			{
+				fclose(file);
+				return error_t::invalidFilePath;
+			}
+
+			binary.resize(fileSize);
+			size_t bytesRead = fread(binary.data(), sizeof(GLubyte), binary.size(), file);
+			fclose(file);
+
+			//SPIR-V is a stream of 32 bit words
+			if (bytesRead != binary.size() || binary.empty() || (binary.size() % 4) != 0)
+			{
+				binary.clear();
+				return error_t::invalidBuffer;
+			}
+			return error_t::success;
+		}
+
+		/*
+		* get the shader specialized with the given constants. variants are only created once per set of values
+		*/
+		std::error_code GetVariant(const std::vector<specializationConstant_t>& constants, std::shared_ptr<shader_t>& outShader)
+		{
+			variantKey_t key = MakeVariantKey(constants);
+			auto existing = variants.find(key);
+			if (existing != variants.end())
+			{
+				outShader = existing->second;
+				return error_t::success;
+			}
+
+			//the variant keeps its own copy of the name so it can outlive the module
+			std::shared_ptr<shader_t> newShader(new shader_t(name.c_str(), type, binary, constants));
+			std::error_code result = newShader->Specialize(binary, entryPoint.c_str(), constants);
+			if (result)
+			{
+				newShader->Shutdown();
+				return result;
+			}
+
+			variants.insert(std::make_pair(key, newShader));
+			outShader = newShader;
+			return error_t::success;
+		}
+
+		/*
+		* delete every variant and let go of the binary
+		*/
+		void Shutdown()
+		{
+			for (auto iter = variants.begin(); iter != variants.end(); iter++)
+			{
+				iter->second->Shutdown();
+			}
+			variants.clear();
+			binary.clear();
+		}
+
+		/*
+		* the variant key is independent of the order the constants were given in
+		*/
+		static variantKey_t MakeVariantKey(std::vector<specializationConstant_t> constants)
+		{
+			std::sort(constants.begin(), constants.end(),
+				[](const specializationConstant_t& left, const specializationConstant_t& right) { return left.index < right.index; });
+
+			variantKey_t key;
+			for (size_t iterator = 0; iterator < constants.size(); iterator++)
+			{
+				key.push_back(constants[iterator].index);
+				key.push_back(constants[iterator].value);
+			}
+			return key;
+		}
+
+		std::string													name;			/**<The name of the module */
+		std::string													filePath;		/**<The file path of the SPIR-V binary*/
+		std::string													entryPoint;		/**<The entry point that every variant is specialized with*/
+		GLuint														type;			/**<The type of shader ( Vertex, Fragment, etc.)*/
+		std::vector<GLubyte>										binary;			/**<The SPIR-V binary, shared by every variant*/
+		std::map<variantKey_t, std::shared_ptr<shader_t>>			variants;		/**<The specialized shaders keyed by their constant values*/
+	};
+
+	/*
+	* what a uniform type is made of. a mat3x4 has 3 columns and 4 rows. samplers and images are set as ints
+	*/
+	struct uniformTypeInfo_t
+	{
+		GLenum				componentType;	/**<GL_FLOAT, GL_INT, GL_UNSIGNED_INT or GL_DOUBLE*/
+		GLint				columns;		/**<1 for scalars and vectors*/
+		GLint				rows;			/**<The number of components of a vector or the rows of a matrix*/
+	};
+
+	/*
+	* get what the given uniform type is made of
+	*/
+	inline uniformTypeInfo_t GetUniformTypeInfo(GLenum type)
+	{
+		switch (type)
+		{
+			case GL_FLOAT:				return { GL_FLOAT, 1, 1 };
+			case gl_float_vec2:			return { GL_FLOAT, 1, 2 };
+			case gl_float_vec3:			return { GL_FLOAT, 1, 3 };
+			case gl_float_vec4:			return { GL_FLOAT, 1, 4 };
+			case gl_float_mat2:			return { GL_FLOAT, 2, 2 };
+			case gl_float_mat3:			return { GL_FLOAT, 3, 3 };
+			case gl_float_mat4:			return { GL_FLOAT, 4, 4 };
+			case gl_float_mat2x3:		return { GL_FLOAT, 2, 3 };
+			case gl_float_mat2x4:		return { GL_FLOAT, 2, 4 };
+			case gl_float_mat3x2:		return { GL_FLOAT, 3, 2 };
+			case gl_float_mat3x4:		return { GL_FLOAT, 3, 4 };
+			case gl_float_mat4x2:		return { GL_FLOAT, 4, 2 };
+			case gl_float_mat4x3:		return { GL_FLOAT, 4, 3 };
+			case GL_DOUBLE:				return { GL_DOUBLE, 1, 1 };
+			case gl_double_vec2:		return { GL_DOUBLE, 1, 2 };
+			case gl_double_vec3:		return { GL_DOUBLE, 1, 3 };
+			case gl_double_vec4:		return { GL_DOUBLE, 1, 4 };
+			case gl_double_mat2:		return { GL_DOUBLE, 2, 2 };
+			case gl_double_mat3:		return { GL_DOUBLE, 3, 3 };
+			case gl_double_mat4:		return { GL_DOUBLE, 4, 4 };
+			case gl_double_mat2x3:		return { GL_DOUBLE, 2, 3 };
+			case gl_double_mat2x4:		return { GL_DOUBLE, 2, 4 };
+			case gl_double_mat3x2:		return { GL_DOUBLE, 3, 2 };
+			case gl_double_mat3x4:		return { GL_DOUBLE, 3, 4 };
+			case gl_double_mat4x2:		return { GL_DOUBLE, 4, 2 };
+			case gl_double_mat4x3:		return { GL_DOUBLE, 4, 3 };
+			case GL_UNSIGNED_INT:		return { GL_UNSIGNED_INT, 1, 1 };
+			case gl_unsigned_int_vec2:	return { GL_UNSIGNED_INT, 1, 2 };
+			case gl_unsigned_int_vec3:	return { GL_UNSIGNED_INT, 1, 3 };
+			case gl_unsigned_int_vec4:	return { GL_UNSIGNED_INT, 1, 4 };
+			case gl_int_vec2:			return { GL_INT, 1, 2 };
+			case gl_int_vec3:			return { GL_INT, 1, 3 };
+			case gl_int_vec4:			return { GL_INT, 1, 4 };
+			case gl_bool_vec2:			return { GL_INT, 1, 2 };
+			case gl_bool_vec3:			return { GL_INT, 1, 3 };
+			case gl_bool_vec4:			return { GL_INT, 1, 4 };
+			//int, bool, samplers and images
+			default:					return { GL_INT, 1, 1 };
+		}
+	}
+
+	/*
+	* compare two blocks of memory. vec4 and matrix values are compared 16 bytes at a time when SSE2 is around
+	*/
+	inline bool MemoryEqual(const void* left, const void* right, size_t size)
+	{
+#if defined(TS_SSE2)
+		const GLubyte* leftBytes = (const GLubyte*)left;
+		const GLubyte* rightBytes = (const GLubyte*)right;
+		for (; size >= 16; size -= 16, leftBytes += 16, rightBytes += 16)
+		{
+			__m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)leftBytes), _mm_loadu_si128((const __m128i*)rightBytes));
+			if (_mm_movemask_epi8(equal) != 0xFFFF)
+			{
+				return false;
+			}
+		}
+		return size == 0 || !memcmp(leftBytes, rightBytes, size);
+#else
+		return !memcmp(left, right, size);
+#endif
+	}
+
+	/*
+	* counts of uniform calls that went to the driver and ones the uniform cache got rid of
+	*/
+	struct uniformStats_t
+	{
+		size_t				callsIssued;	/**<How many glProgramUniform calls were made*/
+		size_t				callsSkipped;	/**<How many calls were skipped because the value hadn't changed*/
+	};
+
+	/*
+	* counts of program binds that went to the driver and ones that were already bound
+	*/
+	struct bindStats_t
+	{
+		size_t				bindsIssued;	/**<How many times glUseProgram was called*/
+		size_t				bindsElided;	/**<How many binds were skipped since the program was already bound*/
+	};
+
+	/*
+	* a uniform_t describes one active uniform of a shader program
+	*/
+	struct uniform_t
+	{
+		GLuint64			nameHash;		/**<The hash of the name of the uniform*/
+		GLint				location;		/**<The location of the uniform*/
+		GLenum				type;			/**<The type of the uniform (gl_float_vec4, etc.)*/
+		GLint				size;			/**<The array size of the uniform. 1 if it isn't an array*/
+	};
+
+	/*
+	* a blockMember_t is one variable of a uniform or shader storage block
+	*/
+	struct blockMember_t
+	{
+		std::string			name;					/**<The name of the member as OpenGL reports it*/
+		GLuint64			nameHash;				/**<The hash of the name*/
+		GLenum				type;					/**<The type of the member (gl_float_vec4, etc.)*/
+		GLint				size;					/**<The array size of the member. 1 if it isn't an array*/
+		GLint				offset;					/**<The byte offset of the member from the start of the block*/
+		GLint				arrayStride;			/**<The bytes between array elements. 0 if it isn't an array*/
+		GLint				matrixStride;			/**<The bytes between matrix columns (or rows if row major). 0 if it isn't a matrix*/
+		GLboolean			rowMajor;				/**<Whether the matrix is stored row major*/
+		GLint				topLevelArraySize;		/**<The array size of the outermost array in a storage block. 0 if unsized*/
+		GLint				topLevelArrayStride;	/**<The stride of the outermost array in a storage block*/
+	};
+
+	/*
+	* a blockLayout_t is the memory layout of a uniform or shader storage block. programs that declare the same
+	* block share one layout object so one buffer layout can feed all of them
+	*/
+	struct blockLayout_t
+	{
+		std::string							name;				/**<The name of the block*/
+		GLuint64							nameHash;			/**<The hash of the name of the block*/
+		GLenum								blockInterface;		/**<gl_uniform_block or gl_shader_storage_block*/
+		GLint								dataSize;			/**<The minimum size of a buffer that backs the block*/
+		std::vector<blockMember_t>			members;			/**<The variables of the block sorted by offset*/
+		GLuint64							layoutHash;			/**<The hash of everything above. blocks with the same hash have the same layout*/
+
+		/*
+		* work out the layout hash from the rest of the layout
+		*/
+		void UpdateLayoutHash()
+		{
+			layoutHash = HashBuffer(name.data(), name.size());
+			layoutHash = HashBuffer(&blockInterface, sizeof(blockInterface), layoutHash);
+			layoutHash = HashBuffer(&dataSize, sizeof(dataSize), layoutHash);
+			for (size_t iterator = 0; iterator < members.size(); iterator++)
+			{
+				const blockMember_t& member = members[iterator];
+				const GLint values[] = { (GLint)member.type, member.size, member.offset, member.arrayStride,
+					member.matrixStride, (GLint)member.rowMajor, member.topLevelArraySize, member.topLevelArrayStride };
+				layoutHash = HashBuffer(&member.nameHash, sizeof(member.nameHash), layoutHash);
+				layoutHash = HashBuffer(values, sizeof(values), layoutHash);
+			}
+		}
+	};
+
+	/*
+	* a block_t is a uniform or shader storage block in one particular program
+	*/
+	struct block_t
+	{
+		GLuint									index;		/**<The index of the block in the program*/
+		GLint									binding;	/**<The buffer binding point the block reads from*/
+		std::shared_ptr<const blockLayout_t>	layout;		/**<The layout of the block. shared between programs by the shader manager*/
+	};
+
+	typedef std::function<void(GLuint programHandle, const std::vector<block_t>& blocks)>		parseBlocks_t;	/**< a callback that gets all the uniform and shader storage blocks of every shader program that gets loaded*/
+
+	/*
+	* turn a block or member name into a C++ identifier. the block prefix and a trailing [0] are dropped,
+	* anything else that isn't allowed in an identifier becomes an underscore
+	*/
+	inline std::string MakeIdentifier(const std::string& name, const std::string& prefix = std::string())
+	{
+		std::string source = name;
+		if (!prefix.empty() && source.compare(0, prefix.size() + 1, prefix + ".") == 0)
+		{
+			source.erase(0, prefix.size() + 1);
+		}
+
+		if (source.size() > 3 && source.compare(source.size() - 3, 3, "[0]") == 0)
+		{
+			source.erase(source.size() - 3);
+		}
+
+		std::string identifier;
+		for (size_t iterator = 0; iterator < source.size(); iterator++)
+		{
+			char character = source[iterator];
+			bool valid = (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') || character == '_';
+			if (character == ']')
+			{
+				continue;
+			}
+			identifier += valid ? character : '_';
+		}
+
+		if (identifier.empty() || (identifier[0] >= '0' && identifier[0] <= '9'))
+		{
+			identifier.insert(0, "_");
+		}
+		return identifier;
+	}
+
+	/*
+	* write a C++ struct that matches the layout of the block byte for byte. the offsets come from the driver,
+	* so std140 and std430 padding (vec3 alignment, array and matrix strides) ends up as explicit padding members
+	* and every offset is checked with a static_assert. the generated code only needs <cstddef> and <cstdint>
+	*/
+	inline void GenerateBlockStruct(const blockLayout_t& layout, const std::string& structName, std::ostream& out)
+	{
+		out << "//" << ((layout.blockInterface == (GLenum)gl_shader_storage_block) ? "buffer " : "uniform ") << layout.name << "\n";
+		out << "struct " << structName << "\n{\n";
+		out << "\tstatic const unsigned long long layoutHash = 0x" << std::hex << layout.layoutHash << std::dec << "ULL;\n";
+
+		GLint position = 0, numPadding = 0;
+		bool runtimeSized = false;
+		std::vector<std::pair<std::string, GLint>> offsets;
+		std::set<std::string> usedNames;
+
+		for (size_t iterator = 0; iterator < layout.members.size(); iterator++)
+		{
+			const blockMember_t& member = layout.members[iterator];
+			if (member.offset < position)
+			{
+				//overlaps the previous member. only happens with aliased names the driver reports twice
+				continue;
+			}
+
+			if (member.offset > position)
+			{
+				out << "\tstd::uint8_t padding" << numPadding++ << "[" << (member.offset - position) << "];\n";
+				position = member.offset;
+			}
+
+			uniformTypeInfo_t info = GetUniformTypeInfo(member.type);
+			const char* componentName = "float";
+			GLint componentSize = 4;
+			switch (info.componentType)
+			{
+				case GL_DOUBLE:			componentName = "double"; componentSize = 8; break;
+				case GL_UNSIGNED_INT:	componentName = "std::uint32_t"; break;
+				case GL_INT:			componentName = "std::int32_t"; break;
+				default:				break;
+			}
+
+			//matrices are stored as columns (or rows) of matrixStride bytes each
+			std::ostringstream dimensions;
+			GLint elementSize = componentSize * info.rows;
+			if (info.columns > 1)
+			{
+				GLint vectors = member.rowMajor ? info.rows : info.columns;
+				GLint vectorStride = (member.matrixStride > 0) ? member.matrixStride : componentSize * (member.rowMajor ? info.columns : info.rows);
+				dimensions << "[" << vectors << "][" << (vectorStride / componentSize) << "]";
+				elementSize = vectors * vectorStride;
+			}
+
+			else if (info.rows > 1)
+			{
+				dimensions << "[" << info.rows << "]";
+			}
+
+			std::string memberName = MakeIdentifier(member.name, layout.name);
+			while (!usedNames.insert(memberName).second)
+			{
+				memberName += "_";
+			}
+
+			//unsized arrays at the end of storage blocks get one element to show the element layout
+			bool isArray = member.size != 1 || member.arrayStride > elementSize;
+			GLint count = (member.size > 0) ? member.size : 1;
+			runtimeSized = runtimeSized || member.size == 0;
+			if (!isArray)
+			{
+				out << "\t" << componentName << " " << memberName << dimensions.str() << ";\n";
+				position += elementSize;
+			}
+
+			else if (member.arrayStride <= elementSize)
+			{
+				out << "\t" << componentName << " " << memberName << "[" << count << "]" << dimensions.str() << ";\n";
+				position += count * elementSize;
+			}
+
+			else
+			{
+				//std140 rounds array elements up to a vec4 so each element carries its own padding
+				out << "\tstruct { " << componentName << " value" << dimensions.str() << "; std::uint8_t padding[" << (member.arrayStride - elementSize) << "]; } "
+					<< memberName << "[" << count << "];\n";
+				position += count * member.arrayStride;
+			}
+			offsets.push_back(std::make_pair(memberName, member.offset));
+		}
+
+		if (position < layout.dataSize && !runtimeSized)
+		{
+			out << "\tstd::uint8_t padding" << numPadding++ << "[" << (layout.dataSize - position) << "];\n";
+			position = layout.dataSize;
+		}
+		out << "};\n";
+
+		for (size_t iterator = 0; iterator < offsets.size(); iterator++)
+		{
+			out << "static_assert(offsetof(" << structName << ", " << offsets[iterator].first << ") == " << offsets[iterator].second
+				<< ", \"" << structName << "::" << offsets[iterator].first << " does not match the GLSL layout\");\n";
+		}
+
+		if (!runtimeSized)
+		{
+			out << "static_assert(sizeof(" << structName << ") == " << layout.dataSize << ", \"" << structName << " does not match the size of the GLSL block\");\n";
+		}
+		out << "\n";
+	}
+
+	/*
+	* write a whole header of block structs. layouts that share a block name but differ get the layout hash added to the name
+	*/
+	inline void GenerateBlockHeader(const std::vector<std::shared_ptr<const blockLayout_t>>& layouts, const std::string& source, std::ostream& out)
+	{
+		out << "//generated by TinyShaders from " << source << ". do not edit, regenerate it when the shaders change\n";
+		out << "#pragma once\n#include <cstddef>\n#include <cstdint>\n\n";
+
+		std::set<std::string> usedNames;
+		for (size_t iterator = 0; iterator < layouts.size(); iterator++)
+		{
+			std::string structName = MakeIdentifier(layouts[iterator]->name);
+			if (!usedNames.insert(structName).second)
+			{
+				std::ostringstream hashedName;
+				hashedName << structName << "_" << std::hex << layouts[iterator]->layoutHash;
+				structName = hashedName.str();
+				usedNames.insert(structName);
+			}
+			GenerateBlockStruct(*layouts[iterator], structName, out);
+		}
+	}
+
+	/*
+	* a programBinary_t is a program binary in memory, read from a file for glProgramBinary or retrieved to be written to one
+	*/
+	struct programBinary_t
+	{
+		std::string				name;			/**<The program name from the header of the file*/
+		GLenum					format;			/**<The binary format the driver gave when the binary was saved*/
+		std::vector<GLchar>		data;			/**<The binary itself*/
+		std::error_code			result;			/**<Whether reading the file worked*/
+	};
+
+	/*
+	* a cacheEntry_t is what the binary cache knows about one file
+	*/
+	struct cacheEntry_t
+	{
+		size_t				size;			/**<The size of the file on disk*/
+		long long			lastUse;		/**<When the binary was last written or loaded, in milliseconds since the epoch*/
+		GLuint				hits;			/**<How many times the binary has been loaded*/
+	};
+
+	/*
+	* a binaryCache_t is an index of the program binaries in defaultBinaryPath. it records the size, last use and hit
+	* count of every binary and Trim deletes the least recently used ones until the cache fits its byte budget. the
+	* index is a text file next to the binaries and is read the first time it's needed
+	*/
+	class binaryCache_t
+	{
+	public:
+
+		binaryCache_t()
+		{
+			budget = 0;
+			loaded = false;
+		}
+
+		/*
+		* set how many bytes of binaries the cache may hold. 0 means no limit
+		*/
+		void SetBudget(size_t bytes)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			budget = bytes;
+		}
+
+		size_t GetBudget()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return budget;
+		}
+
+		/*
+		* whether the index has been read, which means something used the cache
+		*/
+		bool IsLoaded()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return loaded;
+		}
+
+		/*
+		* record that a binary was just written (hit is false) or loaded (hit is true)
+		*/
+		void Touch(const std::string& path, bool hit)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			Load();
+			size_t size = 0;
+			auto entry = entries.find(NormalizePath(path));
+			if (entry == entries.end())
+			{
+				//only files that are there get an entry
+				if (!GetFileSize(path.c_str(), size))
+				{
+					return;
+				}
+				cacheEntry_t newEntry = { size, 0, 0 };
+				entry = entries.insert(std::make_pair(NormalizePath(path), newEntry)).first;
+			}
+
+			else if (!hit && GetFileSize(path.c_str(), size))
+			{
+				entry->second.size = size;
+			}
+			entry->second.lastUse = (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			entry->second.hits += hit ? 1 : 0;
+		}
+
+		/*
+		* bring the index up to date with the directory, delete the least recently used binaries until the cache fits
+		* the budget and save the index. binaries the index didn't know about, such as stale ones from older builds,
+		* are added with their modification time as their last use. returns how many binaries were deleted
+		*/
+		size_t Trim()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			Load();
+
+			std::vector<std::string> files;
+			ListBinaries(directory, files);
+			for (size_t iterator = 0; iterator < files.size(); iterator++)
+			{
+				std::string key = NormalizePath(files[iterator]);
+				struct stat fileStats;
+				if (entries.find(key) == entries.end() && stat(files[iterator].c_str(), &fileStats) == 0)
+				{
+					cacheEntry_t newEntry = { (size_t)fileStats.st_size, (long long)fileStats.st_mtime * 1000, 0 };
+					entries.insert(std::make_pair(key, newEntry));
+				}
+			}
+
+			//forget binaries that were deleted behind our back
+			size_t total = 0;
+			std::vector<std::map<std::string, cacheEntry_t>::iterator> byLastUse;
+			for (auto iter = entries.begin(); iter != entries.end();)
+			{
+				if (!GetFileSize(iter->first.c_str(), iter->second.size))
+				{
+					iter = entries.erase(iter);
+					continue;
+				}
+				total += iter->second.size;
+				byLastUse.push_back(iter);
+				iter++;
+			}
+
+			//oldest first. when two were last used at the same time the one loaded less often goes first
+			std::sort(byLastUse.begin(), byLastUse.end(), [](const std::map<std::string, cacheEntry_t>::iterator& first, const std::map<std::string, cacheEntry_t>::iterator& second)
+			{
+				return (first->second.lastUse != second->second.lastUse) ? first->second.lastUse < second->second.lastUse : first->second.hits < second->second.hits;
+			});
+
+			size_t numEvicted = 0;
+			for (size_t iterator = 0; budget != 0 && total > budget && iterator < byLastUse.size(); iterator++)
+			{
+				if (remove(byLastUse[iterator]->first.c_str()) == 0)
+				{
+					total -= byLastUse[iterator]->second.size;
+					entries.erase(byLastUse[iterator]);
+					numEvicted++;
+				}
+			}
+			Save();
+			return numEvicted;
+		}
+
+	private:
+
+		void Load()
+		{
+			if (loaded)
+			{
+				return;
+			}
+			loaded = true;
+			directory = defaultBinaryPath;
+			indexPath = directory + defaultBinaryCacheIndex;
+
+			FILE* indexFile = fopen(indexPath.c_str(), "r");
+			if (indexFile == nullptr)
+			{
+				return;
+			}
+
+			GLchar magic[255] = {};
+			GLchar path[255] = {};
+			GLint version = 0;
+			GLuint numEntries = 0;
+			if (fscanf(indexFile, "%254s %i\n%u\n", magic, &version, &numEntries) == 3 && strcmp(magic, "TinyShadersBinaryCache") == 0 && version == 1)
+			{
+				for (GLuint iterator = 0; iterator < numEntries; iterator++)
+				{
+					unsigned long long size = 0;
+					cacheEntry_t entry = { 0, 0, 0 };
+					if (fscanf(indexFile, "%254s %llu %lld %u\n", path, &size, &entry.lastUse, &entry.hits) != 4)
+					{
+						break;
+					}
+					entry.size = (size_t)size;
+					entries[path] = entry;
+				}
+			}
+			fclose(indexFile);
+		}
+
+		void Save()
+		{
+			FILE* indexFile = fopen((indexPath + ".tmp").c_str(), "w");
+			if (indexFile == nullptr)
+			{
+				return;
+			}
+
+			fprintf(indexFile, "TinyShadersBinaryCache 1\n%u\n", (GLuint)entries.size());
+			for (auto iter = entries.begin(); iter != entries.end(); iter++)
+			{
+				fprintf(indexFile, "%s %llu %lld %u\n", iter->first.c_str(), (unsigned long long)iter->second.size, iter->second.lastUse, iter->second.hits);
+			}
+
+			bool written = fclose(indexFile) == 0;
+#if defined(TS_WINDOWS)
+			written = written && MoveFileExA((indexPath + ".tmp").c_str(), indexPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			written = written && rename((indexPath + ".tmp").c_str(), indexPath.c_str()) == 0;
+#endif
+			if (!written)
+			{
+				remove((indexPath + ".tmp").c_str());
+			}
+		}
+
+		/*
+		* every file in the directory with the program binary extension
+		*/
+		static void ListBinaries(const std::string& binaryDirectory, std::vector<std::string>& outFiles)
+		{
+			const std::string& extension = defaultProrgamBinaryExtension;
+#if defined(TS_WINDOWS)
+			WIN32_FIND_DATAA found;
+			HANDLE search = FindFirstFileA((binaryDirectory + "*" + extension).c_str(), &found);
+			if (search == INVALID_HANDLE_VALUE)
+			{
+				return;
+			}
+
+			do
+			{
+				outFiles.push_back(binaryDirectory + found.cFileName);
+			} while (FindNextFileA(search, &found));
+			FindClose(search);
+#else
+			DIR* directoryHandle = opendir(binaryDirectory.empty() ? "." : binaryDirectory.c_str());
+			if (directoryHandle == nullptr)
+			{
+				return;
+			}
+
+			for (dirent* entry = readdir(directoryHandle); entry != nullptr; entry = readdir(directoryHandle))
+			{
+				std::string fileName = entry->d_name;
+				if (fileName.size() > extension.size() && fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0)
+				{
+					outFiles.push_back(binaryDirectory + fileName);
+				}
+			}
+			closedir(directoryHandle);
+#endif
+		}
+
+		std::mutex							mutex;			/**<Guards everything below. the writer thread trims while the render thread records hits*/
+		std::map<std::string, cacheEntry_t>	entries;		/**<Every binary in the cache, keyed by normalized path*/
+		std::string							directory;		/**<The directory the binaries are in*/
+		std::string							indexPath;		/**<Where the index is saved*/
+		size_t								budget;			/**<How many bytes the binaries may take up. 0 means no limit*/
+		bool								loaded;			/**<Whether the index has been read*/
+	};
+
+	/*
+	* a binaryWriter_t writes program binaries on a background thread. a batch is written to temporary files, each
+	* flushed to disk and only then renamed over the real files, so a crash never leaves a half written binary behind
+	*/
+	class binaryWriter_t
+	{
+	public:
+
+		typedef std::vector<std::pair<std::string, programBinary_t>>	batch_t;	/**< binaries and the paths they go to*/
+
+		binaryWriter_t()
+		{
+			stopping = false;
+			busy = false;
+			cache = nullptr;
+		}
+
+		~binaryWriter_t()
+		{
+			Stop();
+		}
+
+		/*
+		* hand a batch to the writer thread. the thread is started the first time
+		*/
+		void Queue(batch_t& batch)
+		{
+			if (batch.empty())
+			{
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				batches.push_back(std::move(batch));
+				if (!thread.joinable())
+				{
+					thread = std::thread(&binaryWriter_t::Run, this);
+				}
+			}
+			wake.notify_one();
+		}
+
+		/*
+		* record every binary the thread writes in the given cache, and trim it after each batch if it has a budget
+		*/
+		void SetCache(binaryCache_t* binaryCache)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			cache = binaryCache;
+		}
+
+		/*
+		* wait until every queued batch is on disk
+		*/
+		void Flush()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			idle.wait(lock, [this]() { return batches.empty() && !busy; });
+		}
+
+		/*
+		* write whatever is still queued and stop the thread. Queue starts it again
+		*/
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			wake.notify_one();
+
+			if (thread.joinable())
+			{
+				thread.join();
+			}
+			stopping = false;
+		}
+
+		/*
+		* write a batch on the calling thread, compressing the binaries if compressBinaries is set. returns how many
+		* binaries made it to their real path
+		*/
+		static size_t WriteBatch(const batch_t& batch)
+		{
+			std::vector<bool> written(batch.size(), false);
+			for (size_t iterator = 0; iterator < batch.size(); iterator++)
+			{
+				const programBinary_t& binary = batch[iterator].second;
+				FILE* file = fopen((batch[iterator].first + ".tmp").c_str(), "wb");
+				if (file == nullptr)
+				{
+					continue;
+				}
+
+				fprintf(file, "%s\n", binary.name.c_str());
+				fprintf(file, compressBinaries ? "%i lz4\n" : "%i\n", (GLint)binary.data.size());
+				fprintf(file, "%i\n", binary.format);
+				bool failed = compressBinaries ? !WriteCompressed(file, binary.data.data(), binary.data.size()) :
+					fwrite(binary.data.data(), binary.data.size(), 1, file) != 1;
+
+				//the contents have to be on disk before the rename, or a crash can leave a truncated binary at the real path
+				failed = failed || fflush(file) != 0;
+#if defined(TS_WINDOWS)
+				failed = failed || FlushFileBuffers((HANDLE)_get_osfhandle(_fileno(file))) == 0;
+#elif defined(TS_LINUX)
+				failed = failed || fsync(fileno(file)) != 0;
+#endif
+				written[iterator] = (fclose(file) == 0) && !failed;
+			}
+
+			std::set<std::string> directories;
+
+			size_t numWritten = 0;
+			for (size_t iterator = 0; iterator < batch.size(); iterator++)
+			{
+				const std::string& path = batch[iterator].first;
+				if (!written[iterator])
+				{
+					remove((path + ".tmp").c_str());
+					continue;
+				}
+
+#if defined(TS_WINDOWS)
+				bool renamed = MoveFileExA((path + ".tmp").c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+				bool renamed = rename((path + ".tmp").c_str(), path.c_str()) == 0;
+#endif
+				if (renamed)
+				{
+					size_t slash = path.find_last_of("/\\");
+					directories.insert((slash == std::string::npos) ? std::string(".") : path.substr(0, slash + 1));
+					numWritten++;
+				}
+			}
+
+#if defined(TS_LINUX)
+			//the renames themselves only last once the directories are flushed. on windows MOVEFILE_WRITE_THROUGH does that
+			for (auto iterator = directories.begin(); iterator != directories.end(); iterator++)
+			{
+				int directoryHandle = open(iterator->c_str(), O_RDONLY);
+				if (directoryHandle >= 0)
+				{
+					fsync(directoryHandle);
+					close(directoryHandle);
+				}
+			}
+#endif
+			return numWritten;
+		}
+
+	private:
+
+		void Run()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true)
+			{
+				wake.wait(lock, [this]() { return !batches.empty() || stopping; });
+				if (batches.empty())
+				{
+					break;
+				}
+
+				batch_t batch = std::move(batches.front());
+				batches.pop_front();
+				busy = true;
+				binaryCache_t* batchCache = cache;
+				lock.unlock();
+				WriteBatch(batch);
+				if (batchCache != nullptr)
+				{
+					for (size_t iterator = 0; iterator < batch.size(); iterator++)
+					{
+						batchCache->Touch(batch[iterator].first, false);
+					}
+
+					if (batchCache->GetBudget() != 0)
+					{
+						batchCache->Trim();
+					}
+				}
+				lock.lock();
+				busy = false;
+				idle.notify_all();
+			}
+		}
+
+		std::thread						thread;
+		std::mutex						mutex;			/**<Guards everything below*/
+		std::condition_variable			wake;			/**<Signalled when a batch is queued or the writer is stopped*/
+		std::condition_variable			idle;			/**<Signalled when a batch has been written*/
+		std::list<batch_t>				batches;		/**<Batches waiting for the thread*/
+		bool							stopping;		/**<Whether the thread should finish the queue and stop*/
+		bool							busy;			/**<Whether the thread is writing a batch*/
+		binaryCache_t*					cache;			/**<The cache written binaries are recorded in. may be nullptr*/
+	};
+
+	/*
+	* the order the programs of a config file are linked in. critical programs are linked before anything else
+	* so the first frame only waits on them. background programs are left for UpdateLoading to link a few at a time
+	*/
+	enum class programPriority_t
+	{
+		critical,
+		normal,
+		background,
+	};
+
+	/*
+	* a shaderProgram_t is is essentially an OpengL shader program
+	*/
+	struct shaderProgram_t
+	{
+		shaderProgram_t()
+		{
+			compiled = false;
+			name = 0;
+			handle = 0;
+			uniformCacheEnabled = false;
+			uniformStats = { 0, 0 };
+			pendingHandle = 0;
+			separable = false;
+			contentKey = 0;
+			priority = programPriority_t::normal;
+			binaryRequested = false;
+			savesBinary = false;
+		};
+
+		/*
+		* uses the given values to create an OpenGL shader program
+		*/
+		shaderProgram_t(const GLchar* programName,
+			std::vector< std::string > programInputs,
+			std::vector< std::string > programOutputs,
+			std::vector< std::shared_ptr<shader_t>> programShaders,
+			bool saveBinary = false) :
+			name(programName), inputs(programInputs),
+			outputs(programOutputs), shaders(std::move(programShaders))
+		{
+			compiled = GL_FALSE;
+			uniformCacheEnabled = false;
+			uniformStats = { 0, 0 };
+			pendingHandle = 0;
+			separable = false;
+			contentKey = 0;
+			priority = programPriority_t::normal;
+			binaryRequested = false;
+			savesBinary = false;
+			Compile(saveBinary);
+		};
+
+		/*
+		* another bare bones constructor
+		*/
+		shaderProgram_t(const GLchar* programName) : name(programName)
+		{
+			handle = 0;
+			compiled = false;
+			uniformCacheEnabled = false;
+			uniformStats = { 0, 0 };
+			pendingHandle = 0;
+			separable = false;
+			contentKey = 0;
+			priority = programPriority_t::normal;
+			binaryRequested = false;
+			savesBinary = false;
+		};
+
+		shaderProgram_t(const GLchar* programName, GLuint programHandle) :
+			name(programName), handle(programHandle)
+		{
+			compiled = false;
+			uniformCacheEnabled = false;
+			uniformStats = { 0, 0 };
+			pendingHandle = 0;
+			separable = false;
+			contentKey = 0;
+			priority = programPriority_t::normal;
+			binaryRequested = false;
+			savesBinary = false;
+		}
+
+		~shaderProgram_t() {}
+
+		/*
+		* shut down the shader program. delete it from OpenGL
+		*/
+		void Shutdown()
+		{
+			CancelRelink();
+			glDeleteProgram(handle);
+			attachedShaders.clear();
+
+			//clear up all the shaders
+			for (size_t iterator = 0; iterator < shaders.size(); iterator++)
+			{
+				if (shaders[iterator] != nullptr)
+				{
+					shaders[iterator]->Shutdown();
+				}
+			}
+			shaders.clear();
+			inputs.clear();
+			outputs.clear();
+		}
+
+		/*
+		* build the uniform table of the linked program. block members are left out since they have no location.
+		* arrays are found by their name without the trailing [0]
+		*/
+		void ReflectUniforms()
+		{
+			ReflectUniforms(handle, uniforms, nullptr);
+			if (uniformCacheEnabled)
+			{
+				EnableUniformCache(true);
+			}
+		}
+
+		/*
+		* keep a copy of the last value written to every uniform so that setting the same value again
+		* doesn't reach the driver. the cache starts out empty so the first write always goes through
+		*/
+		void EnableUniformCache(bool enable)
+		{
+			uniformCacheEnabled = enable;
+			uniformShadow.clear();
+			uniformShadowOffsets.clear();
+			uniformShadowValid.clear();
+
+			if (enable)
+			{
+				size_t shadowSize = 0;
+				for (size_t iterator = 0; iterator < uniforms.size(); iterator++)
+				{
+					uniformShadowOffsets.push_back(shadowSize);
+					shadowSize += UniformBytes(uniforms[iterator]);
+					//keep every slot 16 byte aligned
+					shadowSize = (shadowSize + 15) & ~(size_t)15;
+				}
+				uniformShadow.resize(shadowSize);
+				uniformShadowValid.resize(uniforms.size(), GL_FALSE);
+			}
+		}
+
+		/*
+		* forget every cached value. use this when the uniforms were changed behind the program's back
+		*/
+		void InvalidateUniformCache()
+		{
+			std::fill(uniformShadowValid.begin(), uniformShadowValid.end(), GL_FALSE);
+		}
+
+		/*
+		* set a uniform by the hash of its name. the program doesn't need to be bound. values are column major
+		* for matrices and count is the number of array elements to set
+		*/
+		std::error_code SetUniform(GLuint64 nameHash, const GLfloat* values, GLsizei count = 1)
+		{
+			return SetUniformValues(nameHash, values, count, GL_FLOAT);
+		}
+
+		std::error_code SetUniform(GLuint64 nameHash, const GLint* values, GLsizei count = 1)
+		{
+			return SetUniformValues(nameHash, values, count, GL_INT);
+		}
+
+		std::error_code SetUniform(GLuint64 nameHash, const GLuint* values, GLsizei count = 1)
+		{
+			return SetUniformValues(nameHash, values, count, GL_UNSIGNED_INT);
+		}
+
+		std::error_code SetUniform(GLuint64 nameHash, const GLdouble* values, GLsizei count = 1)
+		{
+			return SetUniformValues(nameHash, values, count, GL_DOUBLE);
+		}
+
+		std::error_code SetUniform(GLuint64 nameHash, GLfloat value)
+		{
+			return SetUniformValues(nameHash, &value, 1, GL_FLOAT);
+		}
+
+		std::error_code SetUniform(GLuint64 nameHash, GLint value)
+		{
+			return SetUniformValues(nameHash, &value, 1, GL_INT);
+		}
+
+		std::error_code SetUniform(GLuint64 nameHash, GLuint value)
+		{
+			return SetUniformValues(nameHash, &value, 1, GL_UNSIGNED_INT);
+		}
+
+		std::error_code SetUniform(GLuint64 nameHash, GLdouble value)
+		{
+			return SetUniformValues(nameHash, &value, 1, GL_DOUBLE);
+		}
+
+		/*
+		* find a uniform by the hash of its name. the table is sorted so this is a binary search
+		*/
+		const uniform_t* FindUniform(GLuint64 nameHash) const
+		{
+			auto found = std::lower_bound(uniforms.begin(), uniforms.end(), nameHash,
+				[](const uniform_t& uniform, GLuint64 hash) { return uniform.nameHash < hash; });
+			return (found != uniforms.end() && found->nameHash == nameHash) ? &(*found) : nullptr;
+		}
+
+		/*
+		* get the location of a uniform from the hash of its name. -1 if the program doesn't have it
+		*/
+		GLint GetUniformLocation(GLuint64 nameHash) const
+		{
+			const uniform_t* uniform = FindUniform(nameHash);
+			return (uniform != nullptr) ? uniform->location : -1;
+		}
+
+		/*
+		* query the active uniforms of a program. names are only fetched into outNames when it isn't null
+		*/
+		static void ReflectUniforms(GLuint programHandle, std::vector<uniform_t>& outUniforms, std::vector<std::string>* outNames)
+		{
+			outUniforms.clear();
+			std::vector<std::pair<uniform_t, std::string>> found;
+			std::vector<GLchar> uniformName;
+			GLint numUniforms = 0;
+
+			if (glGetProgramInterfaceiv != nullptr)
+			{
+				GLint maxNameLength = 0;
+				glGetProgramInterfaceiv(programHandle, gl_uniform, gl_active_resources, &numUniforms);
+				glGetProgramInterfaceiv(programHandle, gl_uniform, gl_max_name_length, &maxNameLength);
+				uniformName.resize((size_t)maxNameLength + 1);
+
+				const GLenum properties[] = { gl_block_index, gl_location, gl_type, gl_array_size };
+				for (GLint uniformIter = 0; uniformIter < numUniforms; uniformIter++)
+				{
+					GLint values[4] = {};
+					GLsizei nameLength = 0;
+					glGetProgramResourceiv(programHandle, gl_uniform, (GLuint)uniformIter, 4, properties, 4, nullptr, values);
+					if (values[0] != -1)
+					{
+						continue;
+					}
+
+					glGetProgramResourceName(programHandle, gl_uniform, (GLuint)uniformIter, (GLsizei)uniformName.size(), &nameLength, uniformName.data());
+					uniform_t uniform = { 0, values[1], (GLenum)values[2], values[3] };
+					found.push_back(std::make_pair(uniform, std::string(uniformName.data(), (size_t)nameLength)));
+				}
+			}
+
+			//before OpenGL 4.3
+			else
+			{
+				GLint maxNameLength = 0;
+				glGetProgramiv(programHandle, gl_active_uniforms, &numUniforms);
+				glGetProgramiv(programHandle, gl_active_uniform_max_length, &maxNameLength);
+				uniformName.resize((size_t)maxNameLength + 1);
+
+				for (GLint uniformIter = 0; uniformIter < numUniforms; uniformIter++)
+				{
+					uniform_t uniform = {};
+					GLsizei nameLength = 0;
+					glGetActiveUniform(programHandle, (GLuint)uniformIter, (GLsizei)uniformName.size(), &nameLength, &uniform.size, &uniform.type, uniformName.data());
+					uniform.location = glGetUniformLocation(programHandle, uniformName.data());
+					if (uniform.location != -1)
+					{
+						found.push_back(std::make_pair(uniform, std::string(uniformName.data(), (size_t)nameLength)));
+					}
+				}
+			}
+
+			for (size_t iterator = 0; iterator < found.size(); iterator++)
+			{
+				std::string& name = found[iterator].second;
+				if (name.size() > 3 && !name.compare(name.size() - 3, 3, "[0]"))
+				{
+					name.erase(name.size() - 3);
+				}
+				found[iterator].first.nameHash = HashBuffer(name.data(), name.size());
+			}
+
+			std::sort(found.begin(), found.end(),
+				[](const std::pair<uniform_t, std::string>& left, const std::pair<uniform_t, std::string>& right) { return left.first.nameHash < right.first.nameHash; });
+
+			for (size_t iterator = 0; iterator < found.size(); iterator++)
+			{
+				outUniforms.push_back(found[iterator].first);
+				if (outNames != nullptr)
+				{
+					outNames->push_back(found[iterator].second);
+				}
+			}
+		}
+
+		/*
+		* build the table of uniform and shader storage blocks of the linked program
+		*/
+		void ReflectBlocks()
+		{
+			blocks.clear();
+			if (glGetProgramInterfaceiv != nullptr)
+			{
+				ReflectBlocks(gl_uniform_block, gl_uniform);
+				ReflectBlocks(gl_shader_storage_block, gl_buffer_variable);
+			}
+
+			//before OpenGL 4.3 only uniform blocks can be reflected
+			else
+			{
+				GLint numBlocks = 0;
+				glGetProgramiv(handle, gl_active_uniform_blocks, &numBlocks);
+				for (GLint blockIter = 0; blockIter < numBlocks; blockIter++)
+				{
+					std::shared_ptr<blockLayout_t> layout(new blockLayout_t());
+					block_t block = { (GLuint)blockIter, 0, nullptr };
+					GLint nameLength = 0, numMembers = 0;
+
+					glGetActiveUniformBlockiv(handle, block.index, gl_uniform_block_binding, &block.binding);
+					glGetActiveUniformBlockiv(handle, block.index, gl_uniform_block_data_size, &layout->dataSize);
+					glGetActiveUniformBlockiv(handle, block.index, gl_uniform_block_name_length, &nameLength);
+					glGetActiveUniformBlockiv(handle, block.index, gl_uniform_block_active_uniforms, &numMembers);
+
+					std::vector<GLchar> name((size_t)nameLength + 1);
+					glGetActiveUniformBlockName(handle, block.index, (GLsizei)name.size(), &nameLength, name.data());
+					layout->name.assign(name.data(), (size_t)nameLength);
+					layout->blockInterface = gl_uniform_block;
+
+					std::vector<GLint> memberIndices((size_t)numMembers);
+					glGetActiveUniformBlockiv(handle, block.index, gl_uniform_block_active_uniform_indices, memberIndices.data());
+					const GLuint* indices = (const GLuint*)memberIndices.data();
+
+					std::vector<GLint> types((size_t)numMembers), sizes((size_t)numMembers), offsets((size_t)numMembers),
+						arrayStrides((size_t)numMembers), matrixStrides((size_t)numMembers), rowMajors((size_t)numMembers);
+					glGetActiveUniformsiv(handle, numMembers, indices, gl_uniform_type, types.data());
+					glGetActiveUniformsiv(handle, numMembers, indices, gl_uniform_size, sizes.data());
+					glGetActiveUniformsiv(handle, numMembers, indices, gl_uniform_offset, offsets.data());
+					glGetActiveUniformsiv(handle, numMembers, indices, gl_uniform_array_stride, arrayStrides.data());
+					glGetActiveUniformsiv(handle, numMembers, indices, gl_uniform_matrix_stride, matrixStrides.data());
+					glGetActiveUniformsiv(handle, numMembers, indices, gl_uniform_is_row_major, rowMajors.data());
+
+					for (GLint memberIter = 0; memberIter < numMembers; memberIter++)
+					{
+						GLchar memberName[255] = {};
+						GLsizei memberNameLength = 0;
+						glGetActiveUniformName(handle, indices[memberIter], sizeof(memberName), &memberNameLength, memberName);
+						blockMember_t member = { std::string(memberName, (size_t)memberNameLength), 0, (GLenum)types[(size_t)memberIter], sizes[(size_t)memberIter],
+							offsets[(size_t)memberIter], arrayStrides[(size_t)memberIter], matrixStrides[(size_t)memberIter], (GLboolean)rowMajors[(size_t)memberIter], 0, 0 };
+						layout->members.push_back(member);
+					}
+
+					FinishLayout(*layout);
+					block.layout = layout;
+					blocks.push_back(block);
+				}
+			}
+		}
+
+		/*
+		* find a block by the hash of its name
+		*/
+		const block_t* FindBlock(GLuint64 nameHash) const
+		{
+			for (size_t iterator = 0; iterator < blocks.size(); iterator++)
+			{
+				if (blocks[iterator].layout->nameHash == nameHash)
+				{
+					return &blocks[iterator];
+				}
+			}
+			return nullptr;
+		}
+
+		/*
+		* link the program again from its current shaders into a new OpenGL program. the old program is only
+		* deleted once the new one links, so a failed relink leaves the last good version in place
+		*/
+		std::error_code Relink()
+		{
+			std::error_code result = BeginRelink();
+			return result ? result : FinishRelink();
+		}
+
+		/*
+		* start linking a new version of the program next to the current one, which stays usable until
+		* FinishRelink swaps them. the driver may link in the background, see IsRelinkReady
+		*/
+		std::error_code BeginRelink()
+		{
+			CancelRelink();
+			for (size_t iterator = 0; iterator < shaders.size(); iterator++)
+			{
+				if (shaders[iterator] != nullptr && !shaders[iterator]->isCompiled)
+				{
+					std::error_code result = shaders[iterator]->Restore();
+					if (result)
+					{
+						return result;
+					}
+				}
+			}
+
+			pendingHandle = glCreateProgram();
+			AttachAndLink(pendingHandle, savesBinary || alwaysRetrievableBinaries, pendingAttachedShaders);
+			return error_t::success;
+		}
+
+		/*
+		* whether FinishRelink can be called without waiting on the driver
+		*/
+		bool IsRelinkReady() const
+		{
+			return pendingHandle == 0 || IsCompletionReady(pendingHandle, true);
+		}
+
+		/*
+		* swap the new version in if it linked and delete the old one. the uniform table, the uniform cache and
+		* the blocks are reflected again, and uniformBinding_t notices the new handle and binds itself again.
+		* a program that saves its binary asks for it again, since the one on disk is of the old version.
+		* if it failed to link the current version stays and diagnostics has the link log
+		*/
+		std::error_code FinishRelink()
+		{
+			if (pendingHandle == 0)
+			{
+				return error_t::success;
+			}
+
+			GLint successful = GL_FALSE;
+			glGetProgramiv(pendingHandle, gl_link_status, &successful);
+			diagnostics.clear();
+			if (!successful)
+			{
+				GetDiagnostics(pendingHandle, diagnostics);
+				CancelRelink();
+				return error_t::shaderProgramLinkFailed;
+			}
+
+			glDeleteProgram(handle);
+			handle = pendingHandle;
+			pendingHandle = 0;
+			attachedShaders.swap(pendingAttachedShaders);
+			pendingAttachedShaders.clear();
+			compiled = GL_TRUE;
+			binaryRequested = savesBinary;
+			ReflectUniforms();
+			ReflectBlocks();
+			return error_t::success;
+		}
+
+		/*
+		* drop the version that is still linking, if there is one
+		*/
+		void CancelRelink()
+		{
+			if (pendingHandle != 0)
+			{
+				glDeleteProgram(pendingHandle);
+				pendingHandle = 0;
+			}
+			pendingAttachedShaders.clear();
+		}
+
+		/*
+		* detach the shaders that were attached when the program linked. the program keeps working without them.
+		* a shared shader may have been given a new handle since then, so the handles are the ones recorded at link time
+		*/
+		void DetachShaders()
+		{
+			for (size_t iterator = 0; iterator < attachedShaders.size(); iterator++)
+			{
+				glDetachShader(handle, attachedShaders[iterator]);
+			}
+			attachedShaders.clear();
+		}
+
+		/*
+		* how many bytes the whole of a uniform takes up, all array elements included
+		*/
+		static size_t UniformBytes(const uniform_t& uniform)
+		{
+			uniformTypeInfo_t info = GetUniformTypeInfo(uniform.type);
+			size_t componentSize = (info.componentType == GL_DOUBLE) ? sizeof(GLdouble) : sizeof(GLfloat);
+			return componentSize * (size_t)(info.columns * info.rows) * (size_t)uniform.size;
+		}
+
+		/*
+		* check the value against the cache and only send it to OpenGL if it changed
+		*/
+		template<typename T> std::error_code SetUniformValues(GLuint64 nameHash, const T* values, GLsizei count, GLenum componentType)
+		{
+			const uniform_t* uniform = FindUniform(nameHash);
+			if (uniform == nullptr)
+			{
+				return error_t::uniformNotFound;
+			}
+
+			if (GetUniformTypeInfo(uniform->type).componentType != componentType || values == nullptr)
+			{
+				return error_t::uniformTypeMismatch;
+			}
+
+			SetUniformAt((size_t)(uniform - uniforms.data()), values, count);
+			return error_t::success;
+		}
+
+		/*
+		* set the uniform at the given index of the uniform table. the type has to have been checked already
+		*/
+		template<typename T> void SetUniformAt(size_t index, const T* values, GLsizei count)
+		{
+			const uniform_t* uniform = &uniforms[index];
+			uniformTypeInfo_t info = GetUniformTypeInfo(uniform->type);
+			count = std::min(count, (GLsizei)uniform->size);
+			if (uniformCacheEnabled)
+			{
+				size_t bytes = sizeof(T) * (size_t)(info.columns * info.rows * count);
+				GLubyte* shadow = &uniformShadow[uniformShadowOffsets[index]];
+
+				if (uniformShadowValid[index] && MemoryEqual(shadow, values, bytes))
+				{
+					uniformStats.callsSkipped++;
+					return;
+				}
+
+				memcpy(shadow, values, bytes);
+				//a partial array write only makes the cache trustworthy if it already was
+				uniformShadowValid[index] = uniformShadowValid[index] || count == uniform->size;
+			}
+
+			IssueUniform(uniform->location, uniform->type, count, values);
+			uniformStats.callsIssued++;
+		}
+
+		void IssueUniform(GLint location, GLenum type, GLsizei count, const GLfloat* values)
+		{
+			switch (type)
+			{
+				case gl_float_vec2:		glProgramUniform2fv(handle, location, count, values); break;
+				case gl_float_vec3:		glProgramUniform3fv(handle, location, count, values); break;
+				case gl_float_vec4:		glProgramUniform4fv(handle, location, count, values); break;
+				case gl_float_mat2:		glProgramUniformMatrix2fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat3:		glProgramUniformMatrix3fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat4:		glProgramUniformMatrix4fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat2x3:	glProgramUniformMatrix2x3fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat2x4:	glProgramUniformMatrix2x4fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat3x2:	glProgramUniformMatrix3x2fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat3x4:	glProgramUniformMatrix3x4fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat4x2:	glProgramUniformMatrix4x2fv(handle, location, count, GL_FALSE, values); break;
+				case gl_float_mat4x3:	glProgramUniformMatrix4x3fv(handle, location, count, GL_FALSE, values); break;
+				default:				glProgramUniform1fv(handle, location, count, values); break;
+			}
+		}
+
+		void IssueUniform(GLint location, GLenum type, GLsizei count, const GLdouble* values)
+		{
+			switch (type)
+			{
+				case gl_double_vec2:	glProgramUniform2dv(handle, location, count, values); break;
+				case gl_double_vec3:	glProgramUniform3dv(handle, location, count, values); break;
+				case gl_double_vec4:	glProgramUniform4dv(handle, location, count, values); break;
+				case gl_double_mat2:	glProgramUniformMatrix2dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat3:	glProgramUniformMatrix3dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat4:	glProgramUniformMatrix4dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat2x3:	glProgramUniformMatrix2x3dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat2x4:	glProgramUniformMatrix2x4dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat3x2:	glProgramUniformMatrix3x2dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat3x4:	glProgramUniformMatrix3x4dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat4x2:	glProgramUniformMatrix4x2dv(handle, location, count, GL_FALSE, values); break;
+				case gl_double_mat4x3:	glProgramUniformMatrix4x3dv(handle, location, count, GL_FALSE, values); break;
+				default:				glProgramUniform1dv(handle, location, count, values); break;
+			}
+		}
+
+		void IssueUniform(GLint location, GLenum type, GLsizei count, const GLint* values)
+		{
+			switch (type)
+			{
+				case gl_int_vec2:
+				case gl_bool_vec2:		glProgramUniform2iv(handle, location, count, values); break;
+				case gl_int_vec3:
+				case gl_bool_vec3:		glProgramUniform3iv(handle, location, count, values); break;
+				case gl_int_vec4:
+				case gl_bool_vec4:		glProgramUniform4iv(handle, location, count, values); break;
+				default:				glProgramUniform1iv(handle, location, count, values); break;
+			}
+		}
+
+		void IssueUniform(GLint location, GLenum type, GLsizei count, const GLuint* values)
+		{
+			switch (type)
+			{
+				case gl_unsigned_int_vec2:	glProgramUniform2uiv(handle, location, count, values); break;
+				case gl_unsigned_int_vec3:	glProgramUniform3uiv(handle, location, count, values); break;
+				case gl_unsigned_int_vec4:	glProgramUniform4uiv(handle, location, count, values); break;
+				default:					glProgramUniform1uiv(handle, location, count, values); break;
+			}
+		}
+
+		/*
+		* reflect every block of one program interface along with its members
+		*/
+		void ReflectBlocks(GLenum blockInterface, GLenum memberInterface)
+		{
+			GLint numBlocks = 0, maxNameLength = 0, maxMemberNameLength = 0;
+			glGetProgramInterfaceiv(handle, blockInterface, gl_active_resources, &numBlocks);
+			glGetProgramInterfaceiv(handle, blockInterface, gl_max_name_length, &maxNameLength);
+			glGetProgramInterfaceiv(handle, memberInterface, gl_max_name_length, &maxMemberNameLength);
+
+			std::vector<GLchar> name((size_t)maxNameLength + 1);
+			std::vector<GLchar> memberName((size_t)maxMemberNameLength + 1);
+			const GLenum blockProperties[] = { gl_buffer_binding, gl_buffer_data_size, gl_num_active_variables };
+			const GLenum memberProperties[] = { gl_type, gl_array_size, gl_offset, gl_array_stride, gl_matrix_stride, gl_is_row_major, gl_top_level_array_size, gl_top_level_array_stride };
+			//only buffer variables have the top level array properties
+			const GLsizei numMemberProperties = (memberInterface == gl_buffer_variable) ? 8 : 6;
+
+			for (GLint blockIter = 0; blockIter < numBlocks; blockIter++)
+			{
+				std::shared_ptr<blockLayout_t> layout(new blockLayout_t());
+				block_t block = { (GLuint)blockIter, 0, nullptr };
+				GLint blockValues[3] = {};
+				GLsizei nameLength = 0;
+
+				glGetProgramResourceiv(handle, blockInterface, block.index, 3, blockProperties, 3, nullptr, blockValues);
+				glGetProgramResourceName(handle, blockInterface, block.index, (GLsizei)name.size(), &nameLength, name.data());
+				block.binding = blockValues[0];
+				layout->name.assign(name.data(), (size_t)nameLength);
+				layout->blockInterface = blockInterface;
+				layout->dataSize = blockValues[1];
+
+				std::vector<GLint> memberIndices((size_t)blockValues[2]);
+				const GLenum activeVariables = gl_active_variables;
+				glGetProgramResourceiv(handle, blockInterface, block.index, 1, &activeVariables, (GLsizei)memberIndices.size(), nullptr, memberIndices.data());
+
+				for (size_t memberIter = 0; memberIter < memberIndices.size(); memberIter++)
+				{
+					GLint values[8] = {};
+					GLsizei memberNameLength = 0;
+					glGetProgramResourceiv(handle, memberInterface, (GLuint)memberIndices[memberIter], numMemberProperties, memberProperties, 8, nullptr, values);
+					glGetProgramResourceName(handle, memberInterface, (GLuint)memberIndices[memberIter], (GLsizei)memberName.size(), &memberNameLength, memberName.data());
+
+					blockMember_t member = { std::string(memberName.data(), (size_t)memberNameLength), 0, (GLenum)values[0], values[1],
+						values[2], values[3], values[4], (GLboolean)values[5], values[6], values[7] };
+					layout->members.push_back(member);
+				}
+
+				FinishLayout(*layout);
+				block.layout = layout;
+				blocks.push_back(block);
+			}
+		}
+
+		/*
+		* sort the members of a freshly reflected layout and hash everything
+		*/
+		static void FinishLayout(blockLayout_t& layout)
+		{
+			layout.nameHash = HashBuffer(layout.name.data(), layout.name.size());
+			for (size_t iterator = 0; iterator < layout.members.size(); iterator++)
+			{
+				layout.members[iterator].nameHash = HashBuffer(layout.members[iterator].name.data(), layout.members[iterator].name.size());
+			}
+
+			std::sort(layout.members.begin(), layout.members.end(),
+				[](const blockMember_t& left, const blockMember_t& right) { return left.offset < right.offset; });
+			layout.UpdateLayoutHash();
+		}
+
+		/*
+		* fetch the whole link log of the program and turn it into diagnostics
+		*/
+		void GetDiagnostics(std::vector<diagnostic_t>& outDiagnostics) const
+		{
+			GetDiagnostics(handle, outDiagnostics);
+		}
+
+		/*
+		* fetch the link log of the given version of the program
+		*/
+		void GetDiagnostics(GLuint programHandle, std::vector<diagnostic_t>& outDiagnostics) const
+		{
+			GLint logLength = 0;
+			if (programHandle != 0)
+			{
+				glGetProgramiv(programHandle, gl_info_log_length, &logLength);
+			}
+
+			if (logLength > 1)
+			{
+				std::vector<GLchar> log((size_t)logLength);
+				glGetProgramInfoLog(programHandle, logLength, nullptr, log.data());
+				ParseInfoLog(log.data(), nullptr, name, outDiagnostics);
+			}
+		}
+
+		/*
+		* get the binary of the linked program from the driver
+		*/
+		std::error_code RetrieveBinary(programBinary_t& outBinary) const
+		{
+			GLint binarySize = 0;
+			glGetProgramiv(handle, gl_program_binary_length, &binarySize);
+			if (binarySize <= 0)
+			{
+				return error_t::invalidProgramBinary;
+			}
+
+			outBinary.name = name;
+			outBinary.data.resize((size_t)binarySize);
+			glGetProgramBinary(handle, binarySize, nullptr, &outBinary.format, outBinary.data.data());
+			outBinary.result = error_t::success;
+			return error_t::success;
+		}
+
+		/*
+		* where a binary of the program in the given format is saved. the format and driver are part of the name so
+		* binaries for several GPUs or driver versions can sit side by side
+		*/
+		std::string BinaryPath(GLenum format) const
+		{
+			return ProgramBinaryPath(name, format);
+		}
+
+		/*
+		* get the binary and write it straight away on this thread
+		*/
+		std::error_code SaveBinary()
+		{
+			binaryWriter_t::batch_t batch(1);
+			std::error_code result = RetrieveBinary(batch[0].second);
+			if (result)
+			{
+				return result;
+			}
+
+			batch[0].first = BinaryPath(batch[0].second.format);
+			binaryRequested = false;
+			return (binaryWriter_t::WriteBatch(batch) == 1) ? error_t::success : error_t::invalidFilePath;
+		}
+
+		/*
+		* compile the OpenGL shader program with the given information
+		*/
 		std::error_code Compile(bool saveBinary)
 		{
-			handle = glCreateProgram();
-			GLchar errorLog[512];
-			GLint successful = false;
-			if (!compiled)
+			handle = glCreateProgram();
+			GLint successful = false;
+			if (!compiled)
+			{
+				AttachAndLink(handle, saveBinary || alwaysRetrievableBinaries, attachedShaders);
+				glGetProgramiv(handle, gl_link_status, &successful);
+
+				if (!successful)
+				{
+					GetDiagnostics(diagnostics);
+					return error_t::shaderProgramLinkFailed;
+				}
+
+				//reflect once here so nobody has to look uniforms up by string later
+				ReflectUniforms();
+				ReflectBlocks();
+
+				//the binary isn't fetched here. the shader manager fetches it once the batch is linked and writes it
+				//in the background. programs made without a manager can call SaveBinary
+				binaryRequested = saveBinary;
+				savesBinary = saveBinary;
+				compiled = true;
+				return error_t::success;
+			}
+			return error_t::shaderProgramAlreasyCompiled;
+		}
+
+		/*
+		* a key for everything that decides what the program links to: the inputs, the outputs and the type and
+		* source hash of every shader. programs with the same key link to the same thing
+		*/
+		GLuint64 MakeContentKey() const
+		{
+			std::vector<std::pair<GLuint, GLuint64>> stages;
+			for (size_t iterator = 0; iterator < shaders.size(); iterator++)
+			{
+				if (shaders[iterator] != nullptr)
+				{
+					stages.push_back(std::make_pair(shaders[iterator]->type, shaders[iterator]->contentHash));
+				}
+			}
+			return MakeContentKey(inputs, outputs, stages, separable);
+		}
+
+		/*
+		* the same key from the parts of a program that hasn't been made yet. attach order doesn't change what a
+		* program links to so the shaders are sorted first
+		*/
+		static GLuint64 MakeContentKey(const std::vector<std::string>& programInputs, const std::vector<std::string>& programOutputs,
+			std::vector<std::pair<GLuint, GLuint64>> stages, bool isSeparable = false)
+		{
+			std::sort(stages.begin(), stages.end());
+			GLuint64 key = HashBuffer(&isSeparable, sizeof(isSeparable));
+			for (size_t iterator = 0; iterator < programInputs.size(); iterator++)
+			{
+				key = HashBuffer(programInputs[iterator].c_str(), programInputs[iterator].size() + 1, key);
+			}
+
+			//keeps inputs ("a", "b") and outputs ("a"), ("b") apart
+			key = HashBuffer("|", 1, key);
+			for (size_t iterator = 0; iterator < programOutputs.size(); iterator++)
+			{
+				key = HashBuffer(programOutputs[iterator].c_str(), programOutputs[iterator].size() + 1, key);
+			}
+
+			for (size_t iterator = 0; iterator < stages.size(); iterator++)
+			{
+				key = HashBuffer(&stages[iterator].first, sizeof(GLuint), key);
+				key = HashBuffer(&stages[iterator].second, sizeof(GLuint64), key);
+			}
+			return key;
+		}
+
+		/*
+		* attach the shaders, bind the inputs and outputs and start linking the given program.
+		* outAttached gets the shader handles that were attached to it
+		*/
+		void AttachAndLink(GLuint programHandle, bool retrievable, std::vector<GLuint>& outAttached)
+		{
+			outAttached.clear();
+			for (size_t iterator = 0; iterator < shaders.size(); iterator++)
+			{
+				if (shaders[iterator] != nullptr)
+				{
+					glAttachShader(programHandle, shaders[iterator]->handle);
+					outAttached.push_back(shaders[iterator]->handle);
+				}
+			}
+
+			// specify vertex input attributes
+			for (size_t i = 0; i < inputs.size(); ++i)
+			{
+				glBindAttribLocation(programHandle, (GLuint)i, inputs[i].c_str());
+			}
+
+			// specify pixel shader outputs
+			for (size_t i = 0; i < outputs.size(); ++i)
+			{
+				glBindFragDataLocation(programHandle, (GLuint)i, outputs[i].c_str());
+			}
+
+			if (retrievable)
+			{
+				glProgramParameteri(programHandle, gl_program_binary_retrievable_hint, GL_TRUE);
+			}
+
+			if (separable)
+			{
+				glProgramParameteri(programHandle, gl_program_separable, GL_TRUE);
+			}
+
+			glLinkProgram(programHandle);
+		}
+
+		const GLchar*										name;				/**< The name of the shader program */
+		GLuint												handle;				/**< The OpenGL handle to the shader program */
+		GLboolean											compiled;			/**< Whether the shader program has been linked successfully */
+		std::vector< std::string >							inputs;				/**< The inputs of the shader program as a vector of strings */
+		std::vector< std::string >							outputs;			/**< The outputs of the shader program as a vector of strings */
+		std::vector< std::shared_ptr<shader_t> >			shaders;			/**< The components that the shader program is comprised of as a vector. shaders can be shared between programs */
+		std::vector< uniform_t >							uniforms;			/**< The active uniforms of the program sorted by name hash. filled in once the program links */
+		std::vector< diagnostic_t >							diagnostics;		/**< The link log of the program. only filled in when linking fails */
+		std::vector< block_t >								blocks;				/**< The uniform and shader storage blocks of the program. filled in once the program links */
+		bool												uniformCacheEnabled;	/**< Whether uniform values are checked against the last value written */
+		std::vector< GLubyte >								uniformShadow;			/**< The last value written to each uniform */
+		std::vector< size_t >								uniformShadowOffsets;	/**< Where each uniform's value starts in uniformShadow. same order as uniforms */
+		std::vector< GLboolean >							uniformShadowValid;		/**< Whether the cached value of each uniform can be trusted */
+		uniformStats_t										uniformStats;			/**< How many uniform calls were made and skipped */
+		GLuint												pendingHandle;			/**< A new version of the program that is still linking. 0 if there isn't one */
+		bool												separable;				/**< Whether the program is a single stage linked to be used in program pipelines */
+		GLuint64											contentKey;				/**< The MakeContentKey of the program when the shader manager took it in. 0 if it wasn't worked out */
+		programPriority_t									priority;				/**< When the program was linked while loading its config file */
+		bool												binaryRequested;		/**< Whether a binary should be saved now that the program has linked. the shader manager writes it in the background */
+		bool												savesBinary;			/**< Whether the program keeps a binary on disk. it is asked for again every time the program is relinked */
+		std::vector< GLuint >								attachedShaders;		/**< The shader handles still attached to handle. DetachShaders empties it */
+		std::vector< GLuint >								pendingAttachedShaders;	/**< The shader handles attached to pendingHandle */
+	};
+
+	typedef std::function<void(shaderProgram_t* program)>		programReady_t;		/**< a callback that gets every program loaded from a config file as soon as it is linked*/
+
+	/*
+	* uniformTraits_t says what a C++ type looks like as uniform data: which component type it holds and how many.
+	* specialize it to upload your own math types (a vec4 class for example) through TS_UNIFORMS
+	*/
+	template<typename T> struct uniformTraits_t
+	{
+		static const GLenum componentType = 0;
+		static const GLint components = 0;
+	};
+
+	template<> struct uniformTraits_t<GLfloat>
+	{
+		static const GLenum componentType = GL_FLOAT;
+		static const GLint components = 1;
+	};
+
+	template<> struct uniformTraits_t<GLint>
+	{
+		static const GLenum componentType = GL_INT;
+		static const GLint components = 1;
+	};
+
+	template<> struct uniformTraits_t<GLuint>
+	{
+		static const GLenum componentType = GL_UNSIGNED_INT;
+		static const GLint components = 1;
+	};
+
+	template<> struct uniformTraits_t<GLdouble>
+	{
+		static const GLenum componentType = GL_DOUBLE;
+		static const GLint components = 1;
+	};
+
+	template<typename T, size_t N> struct uniformTraits_t<T[N]>
+	{
+		static const GLenum componentType = uniformTraits_t<T>::componentType;
+		static const GLint components = uniformTraits_t<T>::components * (GLint)N;
+	};
+
+	template<typename T, size_t N> struct uniformTraits_t<std::array<T, N>>
+	{
+		static const GLenum componentType = uniformTraits_t<T>::componentType;
+		static const GLint components = uniformTraits_t<T>::components * (GLint)N;
+	};
+
+	/*
+	* a uniformMember_t is one member of a struct described by TS_UNIFORMS
+	*/
+	struct uniformMember_t
+	{
+		const GLchar*		name;			/**<The name of the member. it has to match the name of the uniform*/
+		size_t				offset;			/**<Where the member is in the struct*/
+		GLenum				componentType;	/**<GL_FLOAT, GL_INT, GL_UNSIGNED_INT or GL_DOUBLE*/
+		GLint				components;		/**<How many components the member holds in total*/
+	};
+
+	template<typename T> uniformMember_t MakeUniformMember(const GLchar* name, size_t offset)
+	{
+		static_assert(uniformTraits_t<T>::components > 0, "this type can't be uploaded as a uniform. specialize TinyShaders::uniformTraits_t for it");
+		return { name, offset, uniformTraits_t<T>::componentType, uniformTraits_t<T>::components };
+	}
+
+	/*
+	* TS_UNIFORMS(Struct, member, ...) describes which members of a struct are uniforms. each member is matched to the
+	* uniform with the same name. use it in the same namespace as the struct. up to 16 members are supported
+	*/
+#define TS_EXPAND(x) x
+#define TS_UNIFORM_MEMBER(Struct, member) TinyShaders::MakeUniformMember<decltype(((Struct*)nullptr)->member)>(#member, offsetof(Struct, member))
+#define TS_FOR_EACH_1(what, Struct, x) what(Struct, x)
+#define TS_FOR_EACH_2(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_1(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_3(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_2(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_4(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_3(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_5(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_4(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_6(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_5(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_7(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_6(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_8(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_7(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_9(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_8(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_10(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_9(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_11(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_10(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_12(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_11(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_13(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_12(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_14(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_13(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_15(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_14(what, Struct, __VA_ARGS__))
+#define TS_FOR_EACH_16(what, Struct, x, ...) what(Struct, x), TS_EXPAND(TS_FOR_EACH_15(what, Struct, __VA_ARGS__))
+#define TS_GET_FOR_EACH(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, NAME, ...) NAME
+#define TS_FOR_EACH(what, Struct, ...) TS_EXPAND(TS_GET_FOR_EACH(__VA_ARGS__, TS_FOR_EACH_16, TS_FOR_EACH_15, TS_FOR_EACH_14, TS_FOR_EACH_13, \
+	TS_FOR_EACH_12, TS_FOR_EACH_11, TS_FOR_EACH_10, TS_FOR_EACH_9, TS_FOR_EACH_8, TS_FOR_EACH_7, TS_FOR_EACH_6, TS_FOR_EACH_5, \
+	TS_FOR_EACH_4, TS_FOR_EACH_3, TS_FOR_EACH_2, TS_FOR_EACH_1)(what, Struct, __VA_ARGS__))
+
+#define TS_UNIFORMS(Struct, ...) \
+	inline const std::vector<TinyShaders::uniformMember_t>& TinyShadersUniformMembers(const Struct*) \
+	{ \
+		static const std::vector<TinyShaders::uniformMember_t> members = { TS_FOR_EACH(TS_UNIFORM_MEMBER, Struct, __VA_ARGS__) }; \
+		return members; \
+	}
+
+	/*
+	* a uniformBinding_t uploads a struct described by TS_UNIFORMS to a shader program. the members are matched to
+	* the program's uniforms once in Bind, so Upload doesn't do any name lookups. if the program has its uniform
+	* cache enabled only the members that changed reach the driver
+	*/
+	template<typename Struct> class uniformBinding_t
+	{
+	public:
+
+		uniformBinding_t()
+		{
+			program = nullptr;
+			boundHandle = 0;
+		}
+
+		/*
+		* match the members of the struct to the uniforms of a linked program. members the program doesn't use
+		* (the compiler might have optimized them out) are skipped. a member with the wrong type is an error
+		*/
+		std::error_code Bind(shaderProgram_t* targetProgram)
+		{
+			program = nullptr;
+			boundMembers.clear();
+			if (targetProgram == nullptr)
+			{
+				return error_t::shaderProgramNotFound;
+			}
+
+			const std::vector<uniformMember_t>& members = TinyShadersUniformMembers((const Struct*)nullptr);
+			for (size_t iterator = 0; iterator < members.size(); iterator++)
+			{
+				const uniformMember_t& member = members[iterator];
+				const uniform_t* uniform = targetProgram->FindUniform(HashName(member.name));
+				if (uniform == nullptr)
+				{
+					continue;
+				}
+
+				uniformTypeInfo_t info = GetUniformTypeInfo(uniform->type);
+				if (info.componentType != member.componentType || info.columns * info.rows * uniform->size != member.components)
+				{
+					boundMembers.clear();
+					return error_t::uniformTypeMismatch;
+				}
+
+				boundMember_t boundMember = { (size_t)(uniform - targetProgram->uniforms.data()), member.offset, member.componentType, (GLsizei)uniform->size };
+				boundMembers.push_back(boundMember);
+			}
+
+			program = targetProgram;
+			boundHandle = targetProgram->handle;
+			return error_t::success;
+		}
+
+		/*
+		* upload every member of the struct to the bound program. if the program was relinked since Bind
+		* the members are matched to its new uniforms first
+		*/
+		void Upload(const Struct& values)
+		{
+			if (program == nullptr || (program->handle != boundHandle && Bind(program)))
+			{
+				return;
+			}
+
+			const GLubyte* base = (const GLubyte*)&values;
+			for (size_t iterator = 0; iterator < boundMembers.size(); iterator++)
+			{
+				const boundMember_t& member = boundMembers[iterator];
+				switch (member.componentType)
+				{
+					case GL_FLOAT:			program->SetUniformAt(member.uniformIndex, (const GLfloat*)(base + member.offset), member.count); break;
+					case GL_INT:			program->SetUniformAt(member.uniformIndex, (const GLint*)(base + member.offset), member.count); break;
+					case GL_UNSIGNED_INT:	program->SetUniformAt(member.uniformIndex, (const GLuint*)(base + member.offset), member.count); break;
+					case GL_DOUBLE:			program->SetUniformAt(member.uniformIndex, (const GLdouble*)(base + member.offset), member.count); break;
+				}
+			}
+		}
+
+	private:
+
+		struct boundMember_t
+		{
+			size_t			uniformIndex;
+			size_t			offset;
+			GLenum			componentType;
+			GLsizei			count;
+		};
+
+		shaderProgram_t*					program;
+		GLuint								boundHandle;
+		std::vector<boundMember_t>			boundMembers;
+	};
+
+	/*
+	* a uniformSlice_t is the piece of the uniform ring that one draw writes its block data into
+	*/
+	struct uniformSlice_t
+	{
+		GLubyte*			data;			/**<Where to write the block data. the memory is mapped for as long as the ring lives*/
+		GLintptr			offset;			/**<The offset of the slice in the ring buffer*/
+		GLsizeiptr			size;			/**<The size of the slice*/
+		GLenum				target;			/**<gl_uniform_buffer or gl_shader_storage_buffer*/
+		GLuint				binding;		/**<The binding point of the block the slice was made for*/
+	};
+
+	/*
+	* a uniformRing_t streams per draw block data through one persistently mapped buffer. the buffer is split into
+	* one region per frame in flight and each region is fenced when its frame ends, so data is never overwritten
+	* while the GPU might still read it. a draw writes its block with a memcpy and binds it with glBindBufferRange
+	*/
+	class uniformRing_t
+	{
+	public:
+
+		uniformRing_t()
+		{
+			handle = 0;
+			mappedBuffer = nullptr;
+			frameSize = 0;
+			frameOffset = 0;
+			currentFrame = 0;
+			alignment = 1;
+			numWaits = 0;
+		}
+
+		~uniformRing_t() {}
+
+		/*
+		* create the buffer. frameSize is how many bytes one frame can allocate
+		*/
+		std::error_code Initialize(GLsizeiptr bytesPerFrame, GLuint framesInFlight = 3)
+		{
+			if (bytesPerFrame <= 0 || framesInFlight == 0 || glBufferStorage == nullptr)
+			{
+				return error_t::uniformRingFailed;
+			}
+
+			//every slice has to start on an offset both block types accept
+			GLint uniformAlignment = 1, storageAlignment = 1;
+			glGetIntegerv(gl_uniform_buffer_offset_alignment, &uniformAlignment);
+			glGetIntegerv(gl_shader_storage_buffer_offset_alignment, &storageAlignment);
+			alignment = (GLsizeiptr)std::max(std::max(uniformAlignment, storageAlignment), 1);
+
+			frameSize = AlignUp(bytesPerFrame);
+			fences.assign(framesInFlight, nullptr);
+			const GLbitfield flags = gl_map_write_bit | gl_map_persistent_bit | gl_map_coherent_bit;
+
+			glGenBuffers(1, &handle);
+			glBindBuffer(gl_uniform_buffer, handle);
+			glBufferStorage(gl_uniform_buffer, frameSize * (GLsizeiptr)framesInFlight, nullptr, flags);
+			mappedBuffer = (GLubyte*)glMapBufferRange(gl_uniform_buffer, 0, frameSize * (GLsizeiptr)framesInFlight, flags);
+			glBindBuffer(gl_uniform_buffer, 0);
+
+			if (mappedBuffer == nullptr)
+			{
+				Shutdown();
+				return error_t::uniformRingFailed;
+			}
+
+			currentFrame = 0;
+			frameOffset = 0;
+			return error_t::success;
+		}
+
+		/*
+		* get room for the data of a reflected block this frame. the slice remembers the block's binding
+		*/
+		std::error_code Allocate(const block_t& block, uniformSlice_t& outSlice)
+		{
+			GLenum target = (block.layout->blockInterface == (GLenum)gl_shader_storage_block) ? (GLenum)gl_shader_storage_buffer : (GLenum)gl_uniform_buffer;
+			std::error_code result = Allocate((GLsizeiptr)block.layout->dataSize, outSlice);
+			outSlice.target = target;
+			outSlice.binding = (GLuint)block.binding;
+			return result;
+		}
+
+		/*
+		* get room for the given number of bytes this frame
+		*/
+		std::error_code Allocate(GLsizeiptr size, uniformSlice_t& outSlice)
+		{
+			outSlice = { nullptr, 0, 0, gl_uniform_buffer, 0 };
+			if (mappedBuffer == nullptr)
+			{
+				return error_t::uniformRingFailed;
+			}
+
+			GLsizeiptr alignedSize = AlignUp(size);
+			if (frameOffset + alignedSize > frameSize)
+			{
+				return error_t::uniformRingFull;
+			}
+
+			outSlice.offset = frameSize * (GLsizeiptr)currentFrame + frameOffset;
+			outSlice.data = mappedBuffer + outSlice.offset;
+			outSlice.size = size;
+			frameOffset += alignedSize;
+			return error_t::success;
+		}
+
+		/*
+		* bind the slice to the binding point of its block
+		*/
+		void Bind(const uniformSlice_t& slice) const
+		{
+			glBindBufferRange(slice.target, slice.binding, handle, slice.offset, slice.size);
+		}
+
+		/*
+		* fence the frame that just finished and move on to the next region, waiting for the GPU if it is still
+		* reading the frame that last used it
+		*/
+		void EndFrame()
+		{
+			if (mappedBuffer == nullptr)
+			{
+				return;
+			}
+
+			fences[currentFrame] = glFenceSync(gl_sync_gpu_commands_complete, 0);
+			currentFrame = (currentFrame + 1) % (GLuint)fences.size();
+			frameOffset = 0;
+
+			GLsync fence = fences[currentFrame];
+			if (fence != nullptr)
+			{
+				GLenum waitResult = glClientWaitSync(fence, 0, 0);
+				while (waitResult == gl_timeout_expired)
+				{
+					numWaits++;
+					waitResult = glClientWaitSync(fence, gl_sync_flush_commands_bit, 1000000);
+				}
+				glDeleteSync(fence);
+				fences[currentFrame] = nullptr;
+			}
+		}
+
+		/*
+		* unmap and delete the buffer
+		*/
+		void Shutdown()
+		{
+			for (size_t iterator = 0; iterator < fences.size(); iterator++)
+			{
+				if (fences[iterator] != nullptr)
+				{
+					glDeleteSync(fences[iterator]);
+				}
+			}
+			fences.clear();
+
+			if (handle != 0)
+			{
+				glBindBuffer(gl_uniform_buffer, handle);
+				if (mappedBuffer != nullptr)
+				{
+					glUnmapBuffer(gl_uniform_buffer);
+				}
+				glBindBuffer(gl_uniform_buffer, 0);
+				glDeleteBuffers(1, &handle);
+			}
+
+			handle = 0;
+			mappedBuffer = nullptr;
+		}
+
+		GLuint						handle;			/**<The OpenGL buffer*/
+		size_t						numWaits;		/**<How many times EndFrame had to wait on the GPU. if this climbs add more frames in flight*/
+
+	private:
+
+		GLsizeiptr AlignUp(GLsizeiptr size) const
+		{
+			return ((size + alignment - 1) / alignment) * alignment;
+		}
+
+		GLubyte*					mappedBuffer;
+		GLsizeiptr					frameSize;
+		GLsizeiptr					frameOffset;
+		GLsizeiptr					alignment;
+		GLuint						currentFrame;
+		std::vector<GLsync>			fences;
+	};
+
+	/*
+	* a fileWatcher_t watches a set of files from a background thread and calls back when one of them is written.
+	* linux uses inotify on the directories of the files, so editors that save by replacing the file are caught too.
+	* other platforms poll the modification times. changes are held back until a file has been quiet for a moment
+	* so a save that writes in several steps is reported once
+	*/
+	class fileWatcher_t
+	{
+	public:
+
+		typedef std::function<void(const std::string& filePath)> fileChanged_t;
+
+		fileWatcher_t()
+		{
+			running = false;
+			inotifyHandle = -1;
+		}
+
+		~fileWatcher_t()
+		{
+			Stop();
+		}
+
+		/*
+		* start the background thread. onChanged is called on that thread
+		*/
+		std::error_code Start(fileChanged_t onChanged)
+		{
+			if (running)
+			{
+				return error_t::success;
+			}
+
+#if defined(TS_LINUX)
+			inotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (inotifyHandle < 0)
+			{
+				return error_t::fileWatcherFailed;
+			}
+
+			//files given to Watch before now get their directories watched here
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				for (auto iterator = files.begin(); iterator != files.end(); ++iterator)
+				{
+					WatchDirectory(iterator->first);
+				}
+			}
+#endif
+			changed = onChanged;
+			running = true;
+			worker = std::thread(&fileWatcher_t::Run, this);
+			return error_t::success;
+		}
+
+		/*
+		* start watching a file. safe to call from any thread, before or after Start. files given to it before
+		* Start are watched from the moment Start is called
+		*/
+		void Watch(const std::string& filePath)
+		{
+			std::string path = NormalizePath(filePath);
+			std::lock_guard<std::mutex> lock(mutex);
+			if (files.find(path) != files.end())
+			{
+				return;
+			}
+
+			files[path] = ModificationTime(path);
+#if defined(TS_LINUX)
+			if (inotifyHandle >= 0)
+			{
+				WatchDirectory(path);
+			}
+#endif
+		}
+
+		/*
+		* stop the background thread and forget every file
+		*/
+		void Stop()
+		{
+			if (running)
+			{
+				running = false;
+				worker.join();
+			}
+
+#if defined(TS_LINUX)
+			if (inotifyHandle >= 0)
+			{
+				close(inotifyHandle);
+				inotifyHandle = -1;
+			}
+#endif
+			std::lock_guard<std::mutex> lock(mutex);
+			files.clear();
+			directories.clear();
+		}
+
+	private:
+
+#if defined(TS_LINUX)
+		/*
+		* watch the directory of a file with inotify. the mutex must be held
+		*/
+		void WatchDirectory(const std::string& path)
+		{
+			size_t lastSlash = path.find_last_of('/');
+			std::string directory = (lastSlash == std::string::npos) ? "." : path.substr(0, lastSlash + 1);
+
+			//inotify_add_watch hands back the same descriptor for a directory it already watches
+			int watch = inotify_add_watch(inotifyHandle, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (watch >= 0)
+			{
+				directories[watch] = (directory == ".") ? "" : directory;
+			}
+		}
+#endif
+
+		void Run()
+		{
+			//how long a file has to stay untouched before it is reported
+			const std::chrono::milliseconds settleTime(50);
+			std::map<std::string, std::chrono::steady_clock::time_point> pending;
+
+			while (running)
+			{
+				std::vector<std::string> touched;
+				WaitForChanges(touched);
+				std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+				for (size_t iterator = 0; iterator < touched.size(); iterator++)
+				{
+					pending[touched[iterator]] = now;
+				}
+
+				for (auto iterator = pending.begin(); iterator != pending.end();)
+				{
+					if (now - iterator->second >= settleTime)
+					{
+						changed(iterator->first);
+						iterator = pending.erase(iterator);
+					}
+
+					else
+					{
+						++iterator;
+					}
+				}
+			}
+		}
+
+		/*
+		* block for a short while and collect the watched files that were written
+		*/
+		void WaitForChanges(std::vector<std::string>& outTouched)
+		{
+#if defined(TS_LINUX)
+			pollfd descriptor = { inotifyHandle, POLLIN, 0 };
+			if (poll(&descriptor, 1, 25) <= 0)
+			{
+				return;
+			}
+
+			alignas(inotify_event) char events[4096];
+			ssize_t length = 0;
+			while ((length = read(inotifyHandle, events, sizeof(events))) > 0)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				for (char* position = events; position < events + length; position += sizeof(inotify_event) + ((inotify_event*)position)->len)
+				{
+					const inotify_event* event = (const inotify_event*)position;
+					auto directory = directories.find(event->wd);
+					if (directory == directories.end() || event->len == 0)
+					{
+						continue;
+					}
+
+					std::string path = directory->second + event->name;
+					if (files.find(path) != files.end())
+					{
+						outTouched.push_back(path);
+					}
+				}
+			}
+#else
+			std::this_thread::sleep_for(std::chrono::milliseconds(250));
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto iterator = files.begin(); iterator != files.end(); ++iterator)
+			{
+				time_t modified = ModificationTime(iterator->first);
+				if (modified != iterator->second)
+				{
+					iterator->second = modified;
+					outTouched.push_back(iterator->first);
+				}
+			}
+#endif
+		}
+
+		static time_t ModificationTime(const std::string& filePath)
+		{
+			struct stat fileStats;
+			return stat(filePath.c_str(), &fileStats) ? 0 : fileStats.st_mtime;
+		}
+
+		std::thread						worker;
+		std::atomic<bool>				running;
+		std::mutex						mutex;
+		fileChanged_t					changed;
+		std::map<std::string, time_t>	files;			/**<Every watched file with the time it was last written*/
+		std::map<int, std::string>		directories;	/**<inotify watch descriptors and the directories they watch*/
+		int								inotifyHandle;
+	};
+
+	/*
+	* a queuedShader_t is one shader entry of a program in a config file
+	*/
+	struct queuedShader_t
+	{
+		std::string			name;			/**<The name of the shader*/
+		std::string			type;			/**<The type as written in the config file (Vertex, FragmentLibrary, etc.)*/
+		std::string			path;			/**<The file the shader is loaded from*/
+		size_t				size;			/**<The size of the file, for load progress*/
+	};
+
+	/*
+	* a queuedProgram_t is a program read from a config file that hasn't been built yet
+	*/
+	struct queuedProgram_t
+	{
+		std::string						name;			/**<The name of the program*/
+		std::vector<std::string>		inputs;			/**<The vertex attributes of the program*/
+		std::vector<std::string>		outputs;		/**<The fragment outputs of the program*/
+		std::vector<queuedShader_t>		shaders;		/**<The shaders the program is made of*/
+		programPriority_t				priority;		/**<The priority from the config file or SetProgramPriority*/
+		bool							saveBinary;		/**<Whether to save a binary of the program once it links*/
+	};
+
+	/*
+	* a binaryStatus_t is what happened to one entry of a binaries config file
+	*/
+	struct binaryStatus_t
+	{
+		std::string				path;			/**<The binary file named in the config file or found for the program named there. empty if none was found*/
+		std::string				name;			/**<The program name from the binary, or the one named in the config file. empty if a named file couldn't be read*/
+		std::error_code			result;			/**<invalidFilePath or invalidProgramBinary if the file couldn't be read, binaryFormatNotSupported if there is no binary this context can load, shaderProgramLoadFailed if the driver rejected it*/
+		shaderProgram_t*		program;		/**<The loaded program. nullptr if it failed*/
+	};
+
+	/*
+	* a loadProgress_t is how far a load job has got
+	*/
+	struct loadProgress_t
+	{
+		GLuint				programsDone;	/**<Programs linked, shared or failed so far*/
+		GLuint				programsTotal;	/**<Programs in the job*/
+		size_t				bytesRead;		/**<Bytes of shader files read so far*/
+		size_t				bytesTotal;		/**<Bytes of shader files in the job*/
+	};
+
+	struct loadJob_t;
+	typedef std::function<void(loadJob_t& job)>		loadComplete_t;		/**< a callback that gets a load job once it has finished or been cancelled*/
+
+	/*
+	* a loadJob_t is a bulk load that shaderManager::UpdateLoading works through a few programs at a time. it can be
+	* paused, resumed and cancelled from any thread. a cancelled job gives back every shader and program it made
+	*/
+	struct loadJob_t
+	{
+		loadJob_t()
+		{
+			programsDone = 0;
+			programsTotal = 0;
+			bytesRead = 0;
+			bytesTotal = 0;
+			cancelled = false;
+			paused = false;
+			finished = false;
+		}
+
+		loadProgress_t Progress() const
+		{
+			loadProgress_t progress = { programsDone, programsTotal, bytesRead, bytesTotal };
+			return progress;
+		}
+
+		/*
+		* stop the job. the next UpdateLoading releases what it has made so far and runs the completion callbacks
+		*/
+		void Cancel()
+		{
+			cancelled = true;
+		}
+
+		/*
+		* keep the job queued without working on it. what it has made so far stays loaded
+		*/
+		void Pause()
+		{
+			paused = true;
+		}
+
+		void Resume()
+		{
+			paused = false;
+		}
+
+		bool IsCancelled() const
+		{
+			return cancelled;
+		}
+
+		bool IsFinished() const
+		{
+			return finished;
+		}
+
+		/*
+		* add a callback for when the job finishes or is cancelled. it runs on the thread that calls UpdateLoading,
+		* or straight away if the job is already over
+		*/
+		void OnComplete(loadComplete_t callback)
+		{
+			{
+				std::lock_guard<std::mutex> lock(callbackMutex);
+				if (!finished)
+				{
+					callbacks.push_back(callback);
+					return;
+				}
+			}
+			callback(*this);
+		}
+
+		/*
+		* mark the job as over and run its callbacks. called by the shader manager
+		*/
+		void Complete()
+		{
+			std::vector<loadComplete_t> completeCallbacks;
+			{
+				std::lock_guard<std::mutex> lock(callbackMutex);
+				finished = true;
+				completeCallbacks.swap(callbacks);
+			}
+
+			for (size_t iterator = 0; iterator < completeCallbacks.size(); iterator++)
+			{
+				completeCallbacks[iterator](*this);
+			}
+		}
+
+		std::vector<shaderProgram_t*>		programs;		/**<The programs the job has loaded. emptied if the job is cancelled*/
+		std::list<queuedProgram_t>			queue;			/**<The programs still to be built, in priority order*/
+		std::vector<std::string>			programNames;	/**<The program names the job added to the shader manager*/
+		std::vector<std::string>			shaderNames;	/**<The shaders the job made*/
+		std::atomic<GLuint>					programsDone;	/**<See loadProgress_t*/
+		std::atomic<GLuint>					programsTotal;	/**<See loadProgress_t*/
+		std::atomic<size_t>					bytesRead;		/**<See loadProgress_t*/
+		std::atomic<size_t>					bytesTotal;		/**<See loadProgress_t*/
+		std::atomic<bool>					cancelled;		/**<Whether Cancel has been called*/
+		std::atomic<bool>					paused;			/**<Whether UpdateLoading skips the job*/
+		std::atomic<bool>					finished;		/**<Whether the job is over, cancelled or not*/
+		std::mutex							callbackMutex;	/**<Guards callbacks and finished*/
+		std::vector<loadComplete_t>			callbacks;		/**<Run once the job is over*/
+	};
+
+	/*
+	* a reloadedSource_t is a shader source that was read again in the background after one of its files changed
+	*/
+	struct reloadedSource_t
+	{
+		std::string							shaderName;		/**<The shader the source belongs to*/
+		std::string							source;			/**<The resolved source, includes and all*/
+		std::vector<sourceChunk_t>			chunks;			/**<Which file every line of the source came from*/
+		std::error_code						result;			/**<Whether reading the files worked*/
+	};
+
+	class shaderManager
+	{
+	public:
+
+		std::map<std::string, std::shared_ptr<shaderProgram_t>>			shaderPrograms;		/**< All loaded shader programs. names whose programs have the same content share one program */
+		std::map<std::string, std::shared_ptr<shader_t>>				shaders;			/**< All loaded shaders*/
+		std::map<std::string, std::unique_ptr<spirvModule_t>>			spirvModules;		/**< All loaded SPIR-V modules*/
+		std::vector<diagnostic_t>										diagnostics;		/**< The logs of every shader and program that failed to build since the last ClearDiagnostics*/
+		memoryReport_t													memorySaved;		/**< How much has been given back since memory lean mode was turned on*/
+		std::map<GLuint64, std::shared_ptr<const blockLayout_t>>		blockLayouts;		/**< Every distinct block layout of the loaded programs, keyed by layout hash*/
+		bindStats_t														bindStats;			/**< How many program binds were issued and skipped*/
+
+		shaderManager()
+		{
+			memoryLean = false;
+			memorySaved = { 0, 0 };
+			bindStats = { 0, 0 };
+			currentContext = nullptr;
+			defaultPriority = programPriority_t::normal;
+			binaryWriter.SetCache(&binaryCache);
+#if defined(TS_EMBEDDED_TABLE)
+			RegisterEmbeddedFiles(TS_EMBEDDED_TABLE);
+#endif
+		}
+		~shaderManager() {}
+
+		/*
+		* shuts down TinyShaders. deletes all OpenGL shaders and shader programs
+		* as well as calling shutdown on all shader and programs and clears all vectors.
+		*/
+		void Shutdown()
+		{
+			EnableHotReload(false);
+
+			//jobs still queued can't finish now so they end as cancelled. everything they made goes below
+			for (auto iter = loadJobs.begin(); iter != loadJobs.end(); iter++)
+			{
+				loadJob_t& job = *iter->get();
+				job.cancelled = true;
+				job.programs.clear();
+				job.Complete();
+			}
+			loadJobs.clear();
+
+			WriteBackBinaries();
+			binaryWriter.Stop();
+			if (binaryCache.IsLoaded())
+			{
+				binaryCache.Trim();
+			}
+
+			for (auto iter = shaders.begin(); iter != shaders.end(); iter++)
+			{	
+				if (iter->second != nullptr)
+				{
+					iter->second->Shutdown();
+				}
+				iter->second.reset();
+			}
+			for (auto iter = spirvModules.begin(); iter != spirvModules.end(); iter++)
+			{
+				iter->second->Shutdown();
+			}
+			//programs can be shared by several names so only shut each one down once
+			std::set<shaderProgram_t*> programsShutDown;
+			for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+			{
+				if (programsShutDown.insert(iter->second.get()).second)
+				{
+					iter->second->Shutdown();
+				}
+			}
+
+			for (auto iter = separableStages.begin(); iter != separableStages.end(); iter++)
+			{
+				iter->second->CancelRelink();
+				glDeleteProgram(iter->second->handle);
+			}
+
+			for (auto iter = pipelines.begin(); iter != pipelines.end(); iter++)
+			{
+				glDeleteProgramPipelines(1, &iter->second);
+			}
+
+			shaderPrograms.clear();
+			programsByContent.clear();
+			pendingBinaries.clear();
+			shaders.clear();
+			shaderFilePaths.clear();
+			spirvModules.clear();
+			separableStages.clear();
+			pipelines.clear();
+			blockLayouts.clear();
+			boundPrograms.clear();
+			boundPipelines.clear();
+		}
+
+		/*
+		* load an OpenGL shader
+		*/
+		std::error_code LoadShader(const GLchar* name, shader_t* outShader, const GLchar* shaderFile, GLuint shaderType)
+		{
+			if (name != nullptr)
+			{
+				if (shaderType <= 5)
+				{
+					shader_t* newShader = new shader_t(name, shaderType, shaderFile);
+					if (newShader->isCompiled)
+					{
+						shaders.insert(std::make_pair(name, std::shared_ptr<shader_t>(newShader)));
+						outShader = shaders[name].get();
+						WatchShader(*outShader, false);
+						return error_t::success;
+					}
+					return error_t::shaderCompileFailed;
+				}
+				return error_t::invalidShaderType;
+			}
+			return error_t::invalidShaderName;
+		}
+
+		/*
+		* loads all shaders and shader programs specified in a custom configuration file. the name of a program can be
+		* followed by its priority (critical, normal or background). critical programs are linked first and normal
+		* ones after them, both before this returns. background programs are queued for UpdateLoading
+		*/
+		std::error_code LoadShaderProgramsFromConfigFile(const GLchar* configPath, std::vector<shaderProgram_t*>& outPrograms, bool saveBinary = false)
+		{
+			std::shared_ptr<loadJob_t> job;
+			return LoadShaderProgramsFromConfigFile(configPath, outPrograms, job, saveBinary);
+		}
+
+		/*
+		* the same as above. outJob holds every program in the file. the ones linked before this returns are already
+		* done, and UpdateLoading works through the background ones. the job has already finished if there aren't any,
+		* so the whole load can be followed the same way. cancelling it while background programs are still queued
+		* gives back everything it made
+		*/
+		std::error_code LoadShaderProgramsFromConfigFile(const GLchar* configPath, std::vector<shaderProgram_t*>& outPrograms,
+			std::shared_ptr<loadJob_t>& outJob, bool saveBinary = false)
+		{
+			std::vector<queuedProgram_t> queuedPrograms;
+			std::error_code result = ReadProgramConfigFile(configPath, saveBinary, queuedPrograms);
+			if (result)
+			{
+				return result;
+			}
+
+			//stable so programs of the same priority keep the order of the file
+			std::stable_sort(queuedPrograms.begin(), queuedPrograms.end(), [](const queuedProgram_t& first, const queuedProgram_t& second)
+			{
+				return first.priority < second.priority;
+			});
+
+			//the critical and normal programs are at the front of the queue and are linked now
+			std::shared_ptr<loadJob_t> job = MakeLoadJob(queuedPrograms);
+			while (!job->queue.empty() && job->queue.front().priority != programPriority_t::background)
+			{
+				queuedProgram_t queuedProgram = std::move(job->queue.front());
+				job->queue.pop_front();
+				BuildQueuedProgram(queuedProgram, outPrograms, job.get());
+				job->programsDone++;
+			}
+
+			if (job->queue.empty())
+			{
+				job->Complete();
+			}
+
+			else
+			{
+				loadJobs.push_back(job);
+			}
+
+			outJob = job;
+			WriteBackBinaries();
+			TrimIfLean();
+			return error_t::success;
+		}
+
+		/*
+		* read a config file and queue all of its programs as a load job for UpdateLoading, critical programs first.
+		* nothing is compiled or linked until then
+		*/
+		std::error_code StartLoadJob(const GLchar* configPath, std::shared_ptr<loadJob_t>& outJob, bool saveBinary = false)
+		{
+			std::vector<queuedProgram_t> queuedPrograms;
+			std::error_code result = ReadProgramConfigFile(configPath, saveBinary, queuedPrograms);
+			if (result)
+			{
+				return result;
+			}
+
+			std::stable_sort(queuedPrograms.begin(), queuedPrograms.end(), [](const queuedProgram_t& first, const queuedProgram_t& second)
+			{
+				return first.priority < second.priority;
+			});
+			outJob = MakeLoadJob(queuedPrograms);
+			loadJobs.push_back(outJob);
+			return error_t::success;
+		}
+
+		/*
+		* work through the queued load jobs in order until the time budget (in milliseconds) runs out. at least one
+		* program is linked per call so a small budget still makes progress. cancelled jobs are released here.
+		* returns true while jobs are left, paused ones included
+		*/
+		bool UpdateLoading(std::vector<shaderProgram_t*>& outLoaded, GLuint budget = 2)
+		{
+			auto start = std::chrono::steady_clock::now();
+			bool outOfTime = false;
+			for (auto iter = loadJobs.begin(); iter != loadJobs.end() && !outOfTime;)
+			{
+				loadJob_t& job = *iter->get();
+				if (job.cancelled)
+				{
+					ReleaseJob(job);
+					job.Complete();
+					iter = loadJobs.erase(iter);
+					continue;
+				}
+
+				if (job.paused)
+				{
+					iter++;
+					continue;
+				}
+
+				while (!job.queue.empty() && !job.cancelled && !outOfTime)
+				{
+					queuedProgram_t queuedProgram = std::move(job.queue.front());
+					job.queue.pop_front();
+					BuildQueuedProgram(queuedProgram, outLoaded, &job);
+					job.programsDone++;
+					outOfTime = std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(budget);
+				}
+
+				if (job.cancelled)
+				{
+					//released at the top of the loop, or on the next call if time ran out
+					continue;
+				}
+
+				if (job.queue.empty())
+				{
+					job.Complete();
+					iter = loadJobs.erase(iter);
+				}
+
+				else
+				{
+					iter++;
+				}
+			}
+
+			WriteBackBinaries();
+			if (loadJobs.empty())
+			{
+				TrimIfLean();
+			}
+			return !loadJobs.empty();
+		}
+
+		/*
+		* set the priority of a program by name. it wins over the priority in the config file. a program that is still
+		* queued in a load job and isn't background anymore is moved to the front of its job
+		*/
+		void SetProgramPriority(const GLchar* programName, programPriority_t priority)
+		{
+			programPriorities[programName] = priority;
+			for (auto jobIter = loadJobs.begin(); jobIter != loadJobs.end(); jobIter++)
+			{
+				std::list<queuedProgram_t>& queue = jobIter->get()->queue;
+				for (auto iter = queue.begin(); iter != queue.end(); iter++)
+				{
+					if (iter->name == programName)
+					{
+						iter->priority = priority;
+						if (priority != programPriority_t::background)
+						{
+							queue.splice(queue.begin(), queue, iter);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		/*
+		* set the priority of programs that have none in the config file or from SetProgramPriority. setting it to
+		* background and marking the few programs the first frame needs as critical keeps startup down to those
+		*/
+		void SetDefaultProgramPriority(programPriority_t priority)
+		{
+			defaultPriority = priority;
+		}
+
+		/*
+		* set the callback that gets every program loaded from a config file as soon as it links, background ones included
+		*/
+		void SetProgramReadyEvent(programReady_t programReady)
+		{
+			programReadyEvent = programReady;
+		}
+
+		/*
+		* limit how many bytes of program binaries are kept in defaultBinaryPath. once set, the least recently used
+		* binaries are deleted in the background after each batch of writes, and at shutdown. 0 means no limit
+		*/
+		void SetBinaryCacheBudget(size_t bytes)
+		{
+			binaryCache.SetBudget(bytes);
+		}
+
+		/*
+		* wait for pending binary writes and trim the binary cache now. returns how many binaries were deleted
+		*/
+		size_t TrimBinaryCache()
+		{
+			FlushBinaryWrites();
+			return binaryCache.Trim();
+		}
+
+		/*
+		* hand the binaries of every linked program that asked for one to the writer thread and wait until they are
+		* on disk. loads write binaries in the background on their own, this is for when they have to be there now
+		*/
+		void FlushBinaryWrites()
+		{
+			WriteBackBinaries();
+			binaryWriter.Flush();
+		}
+
+		/*
+		* loads every program binary listed in a binaries config file. see LoadProgramBinaries
+		*/
+		std::error_code LoadProgramBinariesFromConfigFile(const GLchar* configPath, std::vector<shaderProgram_t*>& outPrograms)
+		{
+			std::vector<binaryStatus_t> statuses;
+			std::error_code result = LoadProgramBinaries(configPath, statuses);
+			for (size_t iterator = 0; iterator < statuses.size(); iterator++)
+			{
+				if (statuses[iterator].program != nullptr)
+				{
+					outPrograms.push_back(statuses[iterator].program);
+				}
+			}
+			return result;
+		}
+
+		/*
+		* loads every program binary listed in a binaries config file. an entry is a program name, and the binary
+		* saved for it in defaultBinaryPath for the first format of this context that has one is used. an entry can
+		* also be the path of a .glbin file. the files are read on worker threads (one per core unless numThreads
+		* says otherwise), then every glProgramBinary call is made back to back before any link status is asked for,
+		* so drivers that load binaries in the background can overlap them. names with no binary for this context
+		* and files tagged for a format or driver it can't load are skipped without being opened. outStatuses gets
+		* one entry per line of the list. returns shaderProgramLoadFailed if any entry failed for another reason
+		*/
+		std::error_code LoadProgramBinaries(const GLchar* configPath, std::vector<binaryStatus_t>& outStatuses, GLuint numThreads = 0)
+		{
+			std::shared_ptr<loadJob_t> job;
+			return LoadProgramBinaries(configPath, outStatuses, job, numThreads);
+		}
+
+		/*
+		* the same as above. outJob is a finished job with the loaded programs and how many bytes were read.
+		* it is left empty if the list can't be read
+		*/
+		std::error_code LoadProgramBinaries(const GLchar* configPath, std::vector<binaryStatus_t>& outStatuses, std::shared_ptr<loadJob_t>& outJob, GLuint numThreads = 0)
+		{
+			outJob.reset();
+			if (configPath == nullptr)
+			{
+				return error_t::invalidFilePath;
+			}
+
+			FILE* configFile = OpenFile(configPath, "r");
+			if (configFile == nullptr)
+			{
+				return error_t::invalidConfigFile;
+			}
+
+			GLuint numBinaries = 0;
+			GLchar entry[255] = {};
+			std::vector<std::string> paths;
+			fscanf(configFile, "%i", &numBinaries);
+			for (GLuint iterator = 0; iterator < numBinaries && fscanf(configFile, "%254s", entry) == 1; iterator++)
+			{
+				paths.push_back(entry);
+			}
+			fclose(configFile);
+
+			//work out which file each entry means. binaries for a format or driver this context can't take aren't opened at all
+			std::vector<GLint> formats = SupportedBinaryFormats();
+			const std::string& extension = defaultProrgamBinaryExtension;
+			std::vector<programBinary_t> binaries(paths.size());
+			std::vector<bool> skipped(paths.size(), false);
+			for (size_t iterator = 0; iterator < paths.size(); iterator++)
+			{
+				std::string& path = paths[iterator];
+				bool isFile = path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+				if (!isFile)
+				{
+					binaries[iterator].name = path;
+					path.clear();
+					size_t size = 0;
+					for (size_t formatIter = 0; formatIter < formats.size() && path.empty(); formatIter++)
+					{
+						std::string candidate = ProgramBinaryPath(binaries[iterator].name, (GLenum)formats[formatIter]);
+						path = GetFileSize(candidate.c_str(), size) ? candidate : path;
+					}
+				}
+
+				GLenum format = 0;
+				GLuint64 driver = 0;
+				if (path.empty() || (ParseBinaryTag(path, format, driver) && (driver != DriverHash() || !BinaryFormatSupported(format))))
+				{
+					binaries[iterator].result = error_t::binaryFormatNotSupported;
+					skipped[iterator] = true;
+				}
+			}
+
+			//read every file in parallel. the workers only touch their own entries
+			std::atomic<size_t> nextBinary(0);
+			auto readBinaries = [&]()
+			{
+				for (size_t index = nextBinary++; index < paths.size(); index = nextBinary++)
+				{
+					if (!skipped[index])
+					{
+						ReadProgramBinary(paths[index].c_str(), binaries[index]);
+					}
+				}
+			};
+
+			size_t threadCount = (numThreads != 0) ? numThreads : std::thread::hardware_concurrency();
+			threadCount = std::max<size_t>(1, std::min(threadCount, paths.size()));
+			std::vector<std::thread> workers;
+			for (size_t iterator = 1; iterator < threadCount; iterator++)
+			{
+				workers.push_back(std::thread(readBinaries));
+			}
+			readBinaries();
+			for (size_t iterator = 0; iterator < workers.size(); iterator++)
+			{
+				workers[iterator].join();
+			}
+
+			//submit everything before asking about any of it
+			std::vector<GLuint> handles(binaries.size(), 0);
+			size_t bytesRead = 0;
+			outStatuses.resize(binaries.size());
+			for (size_t iterator = 0; iterator < binaries.size(); iterator++)
+			{
+				binaryStatus_t& status = outStatuses[iterator];
+				status.path = paths[iterator];
+				status.name = binaries[iterator].name;
+				status.result = binaries[iterator].result;
+				status.program = nullptr;
+
+				//untagged binaries from older versions are checked once their header has been read
+				if (!status.result && !BinaryFormatSupported(binaries[iterator].format))
+				{
+					status.result = error_t::binaryFormatNotSupported;
+				}
+
+				if (status.result)
+				{
+					continue;
+				}
+				bytesRead += binaries[iterator].data.size();
+
+				//this is an anti-trolling measure. a program that is already loaded is left as it is
+				auto existing = shaderPrograms.find(status.name);
+				if (existing != shaderPrograms.end())
+				{
+					status.program = existing->second.get();
+					continue;
+				}
+
+				handles[iterator] = glCreateProgram();
+				glProgramBinary(handles[iterator], binaries[iterator].format, binaries[iterator].data.data(), (GLsizei)binaries[iterator].data.size());
+				std::vector<GLchar>().swap(binaries[iterator].data);
+			}
+
+			std::error_code result = error_t::success;
+			for (size_t iterator = 0; iterator < binaries.size(); iterator++)
+			{
+				binaryStatus_t& status = outStatuses[iterator];
+				//binaries for other formats or drivers are expected to sit next to these, so they don't count as failures
+				if (handles[iterator] == 0)
+				{
+					bool failed = status.result && status.result != error_t::binaryFormatNotSupported;
+					result = failed ? std::error_code(error_t::shaderProgramLoadFailed) : result;
+					continue;
+				}
+
+				GLint isSuccessful = GL_FALSE;
+				glGetProgramiv(handles[iterator], gl_link_status, &isSuccessful);
+
+				//two entries of the list can hold the same program. the first one wins
+				if (!isSuccessful || shaderPrograms.find(status.name) != shaderPrograms.end())
+				{
+					glDeleteProgram(handles[iterator]);
+					status.result = isSuccessful ? std::error_code(error_t::success) : std::error_code(error_t::shaderProgramLoadFailed);
+					status.program = isSuccessful ? shaderPrograms[status.name].get() : nullptr;
+					result = isSuccessful ? result : std::error_code(error_t::shaderProgramLoadFailed);
+					continue;
+				}
+
+				//the program keeps a pointer to its name, so point it at the key
+				auto inserted = shaderPrograms.insert(std::make_pair(status.name, std::shared_ptr<shaderProgram_t>(new shaderProgram_t(nullptr, handles[iterator])))).first;
+				shaderProgram_t* program = inserted->second.get();
+				program->name = inserted->first.c_str();
+				program->compiled = true;
+				program->ReflectUniforms();
+				program->ReflectBlocks();
+				ShareBlocks(program);
+				status.program = program;
+				binaryCache.Touch(status.path, true);
+			}
+
+			std::vector<shaderProgram_t*> loadedPrograms;
+			for (size_t iterator = 0; iterator < outStatuses.size(); iterator++)
+			{
+				if (outStatuses[iterator].program != nullptr)
+				{
+					loadedPrograms.push_back(outStatuses[iterator].program);
+				}
+			}
+			outJob = FinishedLoadJob(loadedPrograms, (GLuint)outStatuses.size(), bytesRead);
+			return result;
+		}
+
+		/*
+		* loads shaders from a config file
+		*/
+		std::error_code LoadShadersFromConfigFile(const GLchar* configFile, std::vector<shader_t*>& outShaders)
+		{
+			FILE* pConfigFile = OpenFile(configFile, "r");
+			int numShaders = 0;
+
+			if (pConfigFile)
+			{
+				//get the number of shaders to load
+				fscanf(pConfigFile, "%i\n", &numShaders);
+				GLchar* shaderName;
+				GLchar*	shaderType;
+				GLchar*	shaderPath;
+
+				GLchar empty[255];
+
+				for (int iterator = 0; iterator < numShaders;
+					iterator++, fscanf(pConfigFile, "\n\n"))
+				{
+					shaderName = empty;
+					fscanf(pConfigFile, "%s\n", shaderName);
+
+					//if it doesn't find an existing shader with a matching name then add it. else ignore it
+					if (shaders.find(shaderName) == shaders.end())
+					{
+						shaderType = empty;
+						fscanf(pConfigFile, "%s\n", shaderType);
+
+						shaderPath = empty;
+						fscanf(pConfigFile, "%s\n", shaderPath);
+
+						bool isLibrary = false;
+						GLuint type = StringToShaderType(shaderType, isLibrary);
+						shader_t* newShader = new shader_t(shaderName, type, shaderPath);
+						newShader->isLibrary = isLibrary;
+						if (newShader->isCompiled)
+						{
+							shaders.insert(std::make_pair(shaderName, std::shared_ptr<shader_t>(newShader)));
+							WatchShader(*newShader, false);
+							return error_t::success;
+						}
+					}
+				}
+				return error_t::shaderNotFound;
+			}
+
+			else
+			{
+				return error_t::invalidConfigFile;
+			}
+		}
+
+		/*
+		* saves all loaded shaders and shader programs to a config file
+		*/
+		std::error_code SaveShaderProgramsToConfigFile(const GLchar* fileName)
+		{
+			//write total amount of shaders
+			FILE* pConfigFile = fopen(fileName, "w+");
+
+			if (pConfigFile)
+			{
+				fprintf(pConfigFile, "%i\n\n", (GLint)shaderPrograms.size());
+
+				for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+				{
+					//write program name. shared programs are written once per name
+					if (iter->second->priority == programPriority_t::normal)
+					{
+						fprintf(pConfigFile, "%s\n", iter->first.c_str());
+					}
+
+					else
+					{
+						fprintf(pConfigFile, "%s %s\n", iter->first.c_str(), PriorityToString(iter->second->priority));
+					}
+
+					//write number of inputs
+					fprintf(pConfigFile, "%i\n", (GLint)iter->second.get()->inputs.size());
+
+					//write inputs
+					for (size_t inputIter = 0; inputIter < iter->second.get()->inputs.size(); inputIter++)
+					{
+						fprintf(pConfigFile, "%s\n", iter->second.get()->inputs[inputIter].c_str());
+					}
+
+					fprintf(pConfigFile, "%i\n", (GLint)iter->second.get()->outputs.size());
+
+					//write outputs
+					for (size_t outputIter = 0; outputIter < iter->second.get()->outputs.size(); outputIter++)
+					{
+						fprintf(pConfigFile, "%s\n", iter->second.get()->outputs[outputIter].c_str());
+					}
+
+					//write number of shaders
+					fprintf(pConfigFile, "%i\n", (GLint)iter->second.get()->shaders.size());
+
+					for (size_t shaderIter = 0; shaderIter < iter->second.get()->shaders.size(); shaderIter++)
+					{
+						//write shader name
+						fprintf(pConfigFile, "%s\n", iter->second.get()->shaders[shaderIter]->name);
+
+						//write shader type
+						fprintf(pConfigFile, "%s%s\n", ShaderTypeToString(iter->second.get()->shaders[shaderIter]->type),
+							iter->second.get()->shaders[shaderIter]->isLibrary ? "Library" : "");
+
+						//write shader file path
+						fprintf(pConfigFile, "%s\n", iter->second.get()->shaders[shaderIter]->filePath);
+					}
+				}
+				fclose(pConfigFile);
+				return error_t::success;
+			}
+
+			else
+			{
+				return error_t::invalidConfigFile;
+			}
+		}
+
+		/*
+		* builds a new OpenGL shader program from already loaded shaders
+		*/
+		std::error_code BuildProgramFromShaders(const GLchar* shaderName,
+			const std::vector< std::string >& inputs,
+			const std::vector< std::string >& outputs,
+			const GLchar* vertexShaderName,
+			const GLchar* fragmentShaderName,
+			const GLchar* geometryShaderName,
+			const GLchar* tessContShaderName,
+			const GLchar* tessEvalShaderName,
+			bool saveBinary = false)
+		{
+				std::vector< std::shared_ptr<shader_t>> reusedShaders;
+				reusedShaders.push_back(AcquireShader(vertexShaderName));
+				reusedShaders.push_back(AcquireShader(fragmentShaderName));
+				reusedShaders.push_back(AcquireShader(geometryShaderName));
+				reusedShaders.push_back(AcquireShader(tessContShaderName));
+				reusedShaders.push_back(AcquireShader(tessEvalShaderName));
+
+				std::vector<shaderProgram_t*> sharedPrograms;
+				if (ShareIdenticalProgram(shaderName, ProgramContentKey(inputs, outputs, reusedShaders), sharedPrograms))
+				{
+					return error_t::success;
+				}
+
+				std::unique_ptr<shaderProgram_t> newShaderProgram(new shaderProgram_t(shaderName, inputs, outputs, std::move(reusedShaders), saveBinary));
+				if (newShaderProgram.get()->compiled)
+				{
+					ShareBlocks(newShaderProgram.get());
+					GLuint64 contentKey = newShaderProgram->MakeContentKey();
+					AddProgram(shaderName, std::shared_ptr<shaderProgram_t>(std::move(newShaderProgram)), contentKey);
+					WriteBackBinaries();
+				}
+
+				else
+				{
+					ReportFailure(newShaderProgram.release());
+				}
+
+				TrimIfLean();
+				return error_t::success;
+		}
+
+		/*
+		* loads an OpengL shader from char buffer
+		*/
+		std::error_code LoadShaderFromBuffer(const char* name, const GLchar* buffer, GLuint shaderType)
+		{
+			if (buffer != nullptr)
+			{
+				if (name != nullptr)
+				{
+					//if the shader doesn't already exist the add it. else ignore it
+					if (shaders.find(name) == shaders.end())
+					{
+						shader_t* newShader = new shader_t(name, buffer, shaderType);
+						if (newShader->isCompiled)
+						{
+							shaders.insert(std::make_pair(name, std::shared_ptr<shader_t>(newShader)));
+						}
+						return error_t::success;
+					}
+					return error_t::shaderAlreadyExists;
+				}
+				return error_t::invalidShaderName;
+			}
+			return error_t::invalidBuffer;
+		}
+
+		/*
+		* loads a SPIR-V module so that shader variants can be specialized from it
+		*/
+		std::error_code LoadSPIRVModule(const GLchar* name, const GLchar* filePath, GLuint shaderType, const GLchar* entryPoint = "main")
+		{
+			if (name == nullptr)
+			{
+				return error_t::invalidShaderName;
+			}
+
+			if (filePath == nullptr)
+			{
+				return error_t::invalidFilePath;
+			}
+
+			if (spirvModules.find(name) != spirvModules.end())
+			{
+				return error_t::spirvModuleAlreadyExists;
+			}
+
+			std::unique_ptr<spirvModule_t> newModule(new spirvModule_t(name, shaderType, filePath, entryPoint));
+			std::error_code result = newModule->Load();
+			if (result)
+			{
+				return result;
+			}
+
+			spirvModules.insert(std::make_pair(name, std::move(newModule)));
+			return error_t::success;
+		}
+
+		/*
+		* get a variant of a loaded SPIR-V module specialized with the given constants.
+		* every variant of a module shares the one binary that was loaded
+		*/
+		std::error_code GetSpecializedShader(const GLchar* moduleName, const std::vector<specializationConstant_t>& constants, std::shared_ptr<shader_t>& outShader)
+		{
+			if (moduleName == nullptr)
+			{
+				return error_t::invalidShaderName;
+			}
+
+			auto module = spirvModules.find(moduleName);
+			if (module == spirvModules.end())
+			{
+				return error_t::spirvModuleNotFound;
+			}
+
+			return module->second->GetVariant(constants, outShader);
+		}
+
+		/*
+		* write a C++ header with a struct for every distinct uniform and storage block of the loaded programs.
+		* the structs can be written straight into a buffer and fail to compile if the GLSL layout changes
+		*/
+		std::error_code SaveBlockHeader(const GLchar* headerPath, const GLchar* source = "TinyShaders")
+		{
+			std::vector<std::shared_ptr<const blockLayout_t>> layouts;
+			for (auto iterator = blockLayouts.begin(); iterator != blockLayouts.end(); ++iterator)
+			{
+				layouts.push_back(iterator->second);
+			}
+
+			//order by name so the header doesn't change when nothing but the hashes do
+			std::stable_sort(layouts.begin(), layouts.end(),
+				[](const std::shared_ptr<const blockLayout_t>& left, const std::shared_ptr<const blockLayout_t>& right) { return left->name < right->name; });
+
+			std::ofstream headerFile(headerPath);
+			if (!headerFile.is_open())
+			{
+				return error_t::invalidFilePath;
+			}
+
+			GenerateBlockHeader(layouts, source, headerFile);
+			return error_t::success;
+		}
+
+		/*
+		* writes every loaded shader program to a single cooked manifest. the manifest holds the
+		* resolved sources, their hashes, a uniform table and the program binaries for the current driver
+		* so that LoadCookedManifest can bring everything back in one step. a program that can't be rebuilt from
+		* source on another driver (loaded from a binary, or made from SPIR-V) isn't cooked. nothing is written and
+		* diagnostics says which programs they are
+		*/
+		std::error_code SaveCookedManifest(const GLchar* cookedPath)
+		{
+			if (cookedPath == nullptr)
+			{
+				return error_t::invalidFilePath;
+			}
+
+			bool missingSources = false;
+			for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+			{
+				const std::vector<std::shared_ptr<shader_t>>& programShaders = iter->second->shaders;
+				bool hasSources = !programShaders.empty();
+				for (size_t shaderIter = 0; shaderIter < programShaders.size(); shaderIter++)
+				{
+					const shader_t* shader = programShaders[shaderIter].get();
+					hasSources = hasSources && (shader == nullptr || !shader->buffer.empty() || shader->filePath != NULL);
+				}
+
+				if (!hasSources)
+				{
+					diagnostics.push_back({ iter->first, 0, severity_t::error, "has no sources to rebuild it from, so it can't be cooked" });
+					missingSources = true;
+				}
+			}
+
+			if (missingSources)
+			{
+				return error_t::invalidSourceFiles;
+			}
+
+			FILE* cookedFile = fopen(cookedPath, "wb");
+			if (cookedFile == nullptr)
+			{
+				return error_t::invalidFilePath;
+			}
+
+			const GLchar* renderer = (const GLchar*)glGetString(GL_RENDERER);
+			const GLchar* version = (const GLchar*)glGetString(GL_VERSION);
+			fprintf(cookedFile, "TinyShadersCooked %i\n", cookedManifestVersion);
+			fprintf(cookedFile, "%s\n", renderer != nullptr ? renderer : "");
+			fprintf(cookedFile, "%s\n", version != nullptr ? version : "");
+			fprintf(cookedFile, "%i\n", (GLint)shaderPrograms.size());
+
+			for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+			{
+				shaderProgram_t* program = iter->second.get();
+				fprintf(cookedFile, "program %s\n", iter->first.c_str());
+
+				fprintf(cookedFile, "%i\n", (GLint)program->inputs.size());
+				for (size_t inputIter = 0; inputIter < program->inputs.size(); inputIter++)
+				{
+					fprintf(cookedFile, "%s\n", program->inputs[inputIter].c_str());
+				}
+
+				fprintf(cookedFile, "%i\n", (GLint)program->outputs.size());
+				for (size_t outputIter = 0; outputIter < program->outputs.size(); outputIter++)
+				{
+					fprintf(cookedFile, "%s\n", program->outputs[outputIter].c_str());
+				}
+
+				//write the resolved sources so the runtime never has to touch the original files.
+				//memory lean mode lets go of the sources of linked programs so those are read again
+				std::vector<shader_t*> programShaders;
+				std::vector<std::string> programSources;
+				for (size_t shaderIter = 0; shaderIter < program->shaders.size(); shaderIter++)
+				{
+					shader_t* shader = program->shaders[shaderIter].get();
+					if (shader == nullptr)
+					{
+						continue;
+					}
+
+					std::string source = shader->buffer;
+					if (source.empty() && shader->filePath != NULL)
+					{
+						std::vector<sourceChunk_t> chunks;
+						std::error_code result = shader->ResolveIncludes(shader->filePath, source, chunks);
+						if (result)
+						{
+							fclose(cookedFile);
+							return result;
+						}
+					}
+
+					if (!source.empty())
+					{
+						programShaders.push_back(shader);
+						programSources.push_back(source);
+					}
+				}
+
+				fprintf(cookedFile, "%i\n", (GLint)programShaders.size());
+				for (size_t shaderIter = 0; shaderIter < programShaders.size(); shaderIter++)
+				{
+					shader_t* shader = programShaders[shaderIter];
+					const std::string& source = programSources[shaderIter];
+					fprintf(cookedFile, "%s\n", shader->name);
+					fprintf(cookedFile, "%u %016llx %u%s\n", shader->type, (unsigned long long)HashBuffer(source.data(), source.size()), (GLuint)source.size(),
+						shader->isLibrary ? " library" : "");
+					fwrite(source.data(), source.size(), 1, cookedFile);
+					fprintf(cookedFile, "\n");
+				}
+
+				//write the uniform table. the names are only there for people reading the file
+				std::vector<uniform_t> uniforms;
+				std::vector<std::string> uniformNames;
+				shaderProgram_t::ReflectUniforms(program->handle, uniforms, &uniformNames);
+
+				fprintf(cookedFile, "%i\n", (GLint)uniforms.size());
+				for (size_t uniformIter = 0; uniformIter < uniforms.size(); uniformIter++)
+				{
+					const uniform_t& uniform = uniforms[uniformIter];
+					fprintf(cookedFile, "%016llx %i %u %i %s\n", (unsigned long long)uniform.nameHash, uniform.location, uniform.type, uniform.size, uniformNames[uniformIter].c_str());
+				}
+
+				//write the program binary. this is only usable on the same driver
+				GLint binarySize = 0;
+				GLenum binaryFormat = 0;
+				glGetProgramiv(program->handle, gl_program_binary_length, &binarySize);
+				std::vector<GLubyte> binary((size_t)binarySize);
+
+				if (binarySize > 0)
+				{
+					glGetProgramBinary(program->handle, binarySize, &binarySize, &binaryFormat, binary.data());
+				}
+
+				if (compressBinaries && binarySize > 0)
+				{
+					fprintf(cookedFile, "%u %i lz4\n", binaryFormat, binarySize);
+					WriteCompressed(cookedFile, binary.data(), (size_t)binarySize);
+				}
+
+				else
+				{
+					fprintf(cookedFile, "%u %i\n", binaryFormat, binarySize);
+					fwrite(binary.data(), (size_t)binarySize, 1, cookedFile);
+				}
+				fprintf(cookedFile, "\n");
+			}
+
+			fclose(cookedFile);
+			return error_t::success;
+		}
+
+		/*
+		* loads every shader program in a cooked manifest. the stored program binaries are used when they
+		* were made by the same driver, otherwise the programs are built from the cooked sources
+		*/
+		std::error_code LoadCookedManifest(const GLchar* cookedPath, std::vector<shaderProgram_t*>& outPrograms)
+		{
+			std::shared_ptr<loadJob_t> job;
+			return LoadCookedManifest(cookedPath, outPrograms, job);
+		}
+
+		/*
+		* the same as above. outJob is a finished job with the loaded programs and the size of the manifest.
+		* it is left empty if the manifest can't be read
+		*/
+		std::error_code LoadCookedManifest(const GLchar* cookedPath, std::vector<shaderProgram_t*>& outPrograms, std::shared_ptr<loadJob_t>& outJob)
+		{
+			outJob.reset();
+			if (cookedPath == nullptr)
+			{
+				return error_t::invalidFilePath;
+			}
+
+			FILE* cookedFile = OpenFile(cookedPath, "rb");
+			if (cookedFile == nullptr)
+			{
+				return error_t::invalidConfigFile;
+			}
+
+			GLchar magic[255] = {};
+			GLint version = 0;
+			GLint numPrograms = 0;
+			std::string cookedRenderer, cookedVersion;
+
+			if (fscanf(cookedFile, "%254s %i\n", magic, &version) != 2 || strcmp(magic, "TinyShadersCooked") || version < 1 || version > cookedManifestVersion ||
+				!ReadLine(cookedFile, cookedRenderer) || !ReadLine(cookedFile, cookedVersion) ||
+				fscanf(cookedFile, "%i\n", &numPrograms) != 1)
+			{
+				fclose(cookedFile);
+				return error_t::invalidCookedManifest;
+			}
+
+			//binaries can only be used on the driver that made them
+			const GLchar* renderer = (const GLchar*)glGetString(GL_RENDERER);
+			const GLchar* driverVersion = (const GLchar*)glGetString(GL_VERSION);
+			bool binariesUsable = renderer != nullptr && driverVersion != nullptr &&
+				cookedRenderer == renderer && cookedVersion == driverVersion;
+			size_t firstProgram = outPrograms.size();
+
+			for (GLint programIter = 0; programIter < numPrograms; programIter++)
+			{
+				GLchar programName[255] = {};
+				GLint numInputs = 0, numOutputs = 0, numShaders = 0, numUniforms = 0, binarySize = 0;
+				GLuint binaryFormat = 0;
+				GLchar entry[255] = {};
+				std::vector<std::string> inputs, outputs;
+				std::vector<std::string> shaderNames, shaderSources;
+				std::vector<GLuint> shaderTypes;
+				std::vector<bool> shaderLibraries;
+				std::vector<std::pair<GLuint, GLuint64>> shaderStages;
+				std::vector<uniform_t> uniforms;
+
+				if (fscanf(cookedFile, "program %254s\n", programName) != 1 || fscanf(cookedFile, "%i\n", &numInputs) != 1)
+				{
+					fclose(cookedFile);
+					return error_t::invalidCookedManifest;
+				}
+
+				for (GLint iterator = 0; iterator < numInputs; iterator++)
+				{
+					fscanf(cookedFile, "%254s\n", entry);
+					inputs.push_back(entry);
+				}
+
+				fscanf(cookedFile, "%i\n", &numOutputs);
+				for (GLint iterator = 0; iterator < numOutputs; iterator++)
+				{
+					fscanf(cookedFile, "%254s\n", entry);
+					outputs.push_back(entry);
+				}
+
+				fscanf(cookedFile, "%i\n", &numShaders);
+				for (GLint iterator = 0; iterator < numShaders; iterator++)
+				{
+					GLuint shaderType = 0;
+					unsigned long long contentHash = 0;
+					GLuint sourceLength = 0;
+					GLchar flag[16] = {};
+
+					if (fscanf(cookedFile, "%254s\n", entry) != 1 || fscanf(cookedFile, "%u %llx %u", &shaderType, &contentHash, &sourceLength) != 3)
+					{
+						fclose(cookedFile);
+						return error_t::invalidCookedManifest;
+					}
+
+					//library shaders are marked with a " library" after the source length
+					int next = fgetc(cookedFile);
+					bool isLibrary = next == ' ' && fscanf(cookedFile, "%15[^\n]", flag) == 1 && strcmp(flag, "library") == 0;
+					if (isLibrary)
+					{
+						next = fgetc(cookedFile);
+					}
+
+					if (next != '\n')
+					{
+						fclose(cookedFile);
+						return error_t::invalidCookedManifest;
+					}
+
+					if (!PayloadFits(cookedFile, sourceLength, false))
+					{
+						fclose(cookedFile);
+						return error_t::invalidCookedManifest;
+					}
+
+					std::string source(sourceLength, '\0');
+					if (fread(&source[0], 1, sourceLength, cookedFile) != sourceLength || fgetc(cookedFile) != '\n' ||
+						HashBuffer(source.data(), source.size()) != (GLuint64)contentHash)
+					{
+						fclose(cookedFile);
+						return error_t::invalidCookedManifest;
+					}
+
+					shaderNames.push_back(entry);
+					shaderTypes.push_back(shaderType);
+					shaderLibraries.push_back(isLibrary);
+					shaderSources.push_back(source);
+					shaderStages.push_back(std::make_pair(shaderType, (GLuint64)contentHash));
+				}
+
+				fscanf(cookedFile, "%i\n", &numUniforms);
+				for (GLint iterator = 0; iterator < numUniforms; iterator++)
+				{
+					uniform_t uniform;
+					unsigned long long nameHash = 0;
+					fscanf(cookedFile, "%llx %i %u %i %254s\n", &nameHash, &uniform.location, &uniform.type, &uniform.size, entry);
+					uniform.nameHash = (GLuint64)nameHash;
+					uniforms.push_back(uniform);
+				}
+
+				bool compressed = false;
+				if (fscanf(cookedFile, "%u %i", &binaryFormat, &binarySize) != 2 || !ReadPayloadCodec(cookedFile, compressed) || binarySize < 0 ||
+					!PayloadFits(cookedFile, (size_t)binarySize, compressed))
+				{
+					fclose(cookedFile);
+					return error_t::invalidCookedManifest;
+				}
+
+				std::vector<GLubyte> binary((size_t)binarySize);
+				bool read = compressed ? ReadCompressed(cookedFile, binary.data(), binary.size()) :
+					fread(binary.data(), 1, binary.size(), cookedFile) == binary.size();
+				if (!read || fgetc(cookedFile) != '\n')
+				{
+					fclose(cookedFile);
+					return error_t::invalidCookedManifest;
+				}
+
+				//this is an anti-trolling measure. If a shader with the same name already exists the don't bother making a new one.
+				if (shaderPrograms.find(programName) != shaderPrograms.end())
+				{
+					continue;
+				}
+
+				GLuint64 contentKey = shaderProgram_t::MakeContentKey(inputs, outputs, shaderStages);
+				if (ShareIdenticalProgram(programName, contentKey, outPrograms))
+				{
+					continue;
+				}
+
+				std::unique_ptr<shaderProgram_t> newProgram;
+				if (binariesUsable && binarySize > 0 && BinaryFormatSupported(binaryFormat))
+				{
+					GLint isSuccessful = GL_FALSE;
+					GLuint programHandle = glCreateProgram();
+					glProgramBinary(programHandle, binaryFormat, binary.data(), binarySize);
+					glGetProgramiv(programHandle, gl_link_status, &isSuccessful);
+
+					if (isSuccessful)
+					{
+						newProgram.reset(new shaderProgram_t(programName, programHandle));
+						newProgram->inputs = inputs;
+						newProgram->outputs = outputs;
+						newProgram->compiled = true;
+						newProgram->ReflectBlocks();
+						//the locations were worked out by the driver that made the binary. a rebuilt program reflects its own
+						newProgram->uniforms = uniforms;
+					}
+
+					else
+					{
+						glDeleteProgram(programHandle);
+					}
+				}
+
+				//fall back to building from the cooked sources
+				if (newProgram == nullptr)
+				{
+					std::vector< std::shared_ptr<shader_t>> newShaders;
+					for (size_t iterator = 0; iterator < shaderNames.size(); iterator++)
+					{
+						auto existing = shaders.find(shaderNames[iterator]);
+						if (existing == shaders.end())
+						{
+							shader_t* newShader = new shader_t(shaderNames[iterator].c_str(), shaderSources[iterator], shaderTypes[iterator]);
+							newShader->isLibrary = shaderLibraries[iterator];
+							if (!newShader->isCompiled)
+							{
+								ReportFailure(newShader);
+								continue;
+							}
+							existing = shaders.insert(std::make_pair(shaderNames[iterator], newShader)).first;
+							//the map key outlives the local name
+							existing->second->name = existing->first.c_str();
+						}
+						newShaders.push_back(AcquireShader(existing->first.c_str()));
+					}
+
+					newProgram.reset(new shaderProgram_t(programName, inputs, outputs, std::move(newShaders)));
+					if (!newProgram->compiled)
+					{
+						ReportFailure(newProgram.release());
+						continue;
+					}
+				}
+
+				auto inserted = AddProgram(programName, std::shared_ptr<shaderProgram_t>(std::move(newProgram)), contentKey);
+				inserted->second->name = inserted->first.c_str();
+				outPrograms.push_back(inserted->second.get());
+				ShareBlocks(inserted->second.get());
+			}
+
+			long bytesRead = ftell(cookedFile);
+			fclose(cookedFile);
+			outJob = FinishedLoadJob(std::vector<shaderProgram_t*>(outPrograms.begin() + firstProgram, outPrograms.end()), (GLuint)numPrograms, (size_t)std::max(0L, bytesRead));
+			TrimIfLean();
+			return error_t::success;
+		}
+
+		/*
+		* in memory lean mode the shader objects are detached and deleted as soon as every program that
+		* uses them has linked, and shader sources that can be read from disk again are let go of.
+		* released shaders are brought back automatically if a new program needs them
+		*/
+		void SetMemoryLean(bool lean)
+		{
+			memoryLean = lean;
+			if (lean)
+			{
+				TrimIfLean();
+			}
+		}
+
+		/*
+		* detach and delete every shader object that no unlinked program still needs. this works
+		* whether memory lean mode is on or not
+		*/
+		void TrimShaders(memoryReport_t& outReport)
+		{
+			outReport = { 0, 0 };
+
+			//a shader is still needed while any program that uses it hasn't linked yet
+			std::set<shader_t*> neededShaders;
+			for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+			{
+				shaderProgram_t* program = iter->second.get();
+				for (size_t shaderIter = 0; shaderIter < program->shaders.size(); shaderIter++)
+				{
+					if (!program->compiled)
+					{
+						neededShaders.insert(program->shaders[shaderIter].get());
+					}
+				}
+
+				if (program->compiled)
+				{
+					program->DetachShaders();
+				}
+			}
+
+			for (auto iter = shaders.begin(); iter != shaders.end(); iter++)
+			{
+				shader_t* shader = iter->second.get();
+				if (shader != nullptr && shader->isCompiled && neededShaders.find(shader) == neededShaders.end())
+				{
+					outReport.sourceBytesReleased += shader->Release();
+					outReport.shaderObjectsDeleted++;
+				}
+			}
+		}
+
+		/*
+		* forget the diagnostics of earlier failures
+		*/
+		void ClearDiagnostics()
+		{
+			diagnostics.clear();
+		}
+
+		/*
+		* bind a shader program, skipping the call when it is already bound on the current context.
+		* binding through the manager also makes programs cheap to sort draws by, since the handle is the key
+		*/
+		void BindProgram(const shaderProgram_t* program)
+		{
+			BindProgram((program != nullptr) ? program->handle : 0);
+		}
+
+		void BindProgram(GLuint programHandle)
+		{
+			const void* context = BindContext();
+			auto bound = boundPrograms.find(context);
+			if (bound != boundPrograms.end() && bound->second == programHandle)
+			{
+				bindStats.bindsElided++;
+				return;
+			}
+
+			glUseProgram(programHandle);
+			boundPrograms[context] = programHandle;
+			bindStats.bindsIssued++;
+		}
+
+		/*
+		* get the program the manager last bound on the current context. 0 if nothing or it isn't known
+		*/
+		GLuint GetBoundProgram() const
+		{
+			auto bound = boundPrograms.find(BindContext());
+			return (bound != boundPrograms.end()) ? bound->second : 0;
+		}
+
+		/*
+		* binds are tracked per native context (the EGL, WGL or GLX context that is current) without this. call it
+		* to key them by something else that identifies the context, the window for example. nullptr goes back to
+		* the native context
+		*/
+		void SetCurrentContext(const void* contextKey)
+		{
+			currentContext = contextKey;
+		}
+
+		/*
+		* forget what is bound on the current context. call this after binding programs without the manager
+		*/
+		void InvalidateBindState()
+		{
+			boundPrograms.erase(BindContext());
+			boundPipelines.erase(BindContext());
+		}
+
+		/*
+		* link a loaded shader on its own as a separable program so it can be mixed with other stages in a
+		* program pipeline. N vertex and M fragment shaders then cost N + M links instead of N * M.
+		* stages are cached by shader name. uniforms are set on the stage that declares them
+		*/
+		std::error_code LoadSeparableStage(const GLchar* shaderName, shaderProgram_t*& outStage,
+			std::vector<std::string> inputs = std::vector<std::string>(), std::vector<std::string> outputs = std::vector<std::string>())
+		{
+			outStage = nullptr;
+			if (shaderName == nullptr)
+			{
+				return error_t::invalidShaderName;
+			}
+
+			auto existing = separableStages.find(shaderName);
+			if (existing != separableStages.end())
+			{
+				outStage = existing->second.get();
+				return error_t::success;
+			}
+
+			std::shared_ptr<shader_t> shader = AcquireShader(shaderName);
+			if (shader == nullptr || !shader->isCompiled)
+			{
+				return error_t::shaderNotFound;
+			}
+
+			//a library has no main so it can't be a stage on its own
+			if (shader->isLibrary)
+			{
+				return error_t::notSeparableStage;
+			}
+
+			shaderProgram_t* newStage = new shaderProgram_t(shader->name);
+			newStage->inputs = std::move(inputs);
+			newStage->outputs = std::move(outputs);
+			newStage->shaders.push_back(shader);
+			newStage->separable = true;
+
+			std::error_code result = newStage->Compile(false);
+			if (result)
+			{
+				ReportFailure(newStage);
+				return result;
+			}
+
+			separableStages.insert(std::make_pair(shaderName, std::unique_ptr<shaderProgram_t>(newStage)));
+			ShareBlocks(newStage);
+			outStage = newStage;
+			return error_t::success;
+		}
+
+		/*
+		* get a program pipeline made of the given separable stages. pipelines are cached by the handles of their
+		* stages so asking for the same combination again is only a lookup. a stage that gets hot reloaded
+		* gets a new handle, so ask again every time rather than keeping the pipeline around
+		*/
+		std::error_code GetPipeline(const std::vector<const shaderProgram_t*>& stages, GLuint& outPipeline)
+		{
+			outPipeline = 0;
+			if (glGenProgramPipelines == nullptr)
+			{
+				return error_t::pipelinesNotSupported;
+			}
+
+			std::vector<GLuint> key;
+			for (size_t iterator = 0; iterator < stages.size(); iterator++)
+			{
+				if (stages[iterator] == nullptr || !stages[iterator]->compiled || !stages[iterator]->separable || stages[iterator]->shaders.empty())
+				{
+					return error_t::notSeparableStage;
+				}
+				key.push_back(stages[iterator]->handle);
+			}
+			std::sort(key.begin(), key.end());
+
+			auto existing = pipelines.find(key);
+			if (existing != pipelines.end())
+			{
+				outPipeline = existing->second;
+				return error_t::success;
+			}
+
+			glGenProgramPipelines(1, &outPipeline);
+			for (size_t iterator = 0; iterator < stages.size(); iterator++)
+			{
+				glUseProgramStages(outPipeline, ShaderTypeToStageBit(stages[iterator]->shaders[0]->type), stages[iterator]->handle);
+			}
+			pipelines.insert(std::make_pair(key, outPipeline));
+			return error_t::success;
+		}
+
+		/*
+		* get the pipeline for the named shaders, linking any of them that isn't a separable stage yet
+		*/
+		std::error_code GetPipeline(const std::vector<std::string>& shaderNames, GLuint& outPipeline)
+		{
+			outPipeline = 0;
+			std::vector<const shaderProgram_t*> stages;
+			for (size_t iterator = 0; iterator < shaderNames.size(); iterator++)
+			{
+				shaderProgram_t* stage = nullptr;
+				std::error_code result = LoadSeparableStage(shaderNames[iterator].c_str(), stage);
+				if (result)
+				{
+					return result;
+				}
+				stages.push_back(stage);
+			}
+			return GetPipeline(stages, outPipeline);
+		}
+
+		/*
+		* bind a program pipeline, skipping the call when it is already bound on the current context. a bound
+		* program wins over a bound pipeline so the program is unbound first
+		*/
+		void BindPipeline(GLuint pipeline)
+		{
+			const void* context = BindContext();
+
+			//unbinding the program is part of binding the pipeline so it isn't counted as a program bind
+			auto boundProgram = boundPrograms.find(context);
+			if (boundProgram == boundPrograms.end() || boundProgram->second != 0)
+			{
+				glUseProgram(0);
+				boundPrograms[context] = 0;
+			}
+
+			auto bound = boundPipelines.find(context);
+			if (bound != boundPipelines.end() && bound->second == pipeline)
+			{
+				bindStats.bindsElided++;
+				return;
+			}
+
+			glBindProgramPipeline(pipeline);
+			boundPipelines[context] = pipeline;
+			bindStats.bindsIssued++;
+		}
+
+		/*
+		* set the callback that gets the reflected uniform and shader storage blocks of every program as it loads
+		*/
+		void SetShaderBlockParseEvent(parseBlocks_t shaderBlockParse)
+		{
+			shaderBlocksEvent = shaderBlockParse;
+		}
+
+		/*
+		* start or stop watching the files of every loaded shader, includes and all. shaders loaded from files later are
+		* watched as they load. changed files are read again on the watcher thread. identical programs loaded
+		* before this share one program, so an edit reaches them all only through the files of the first name;
+		* turn hot reload on before loading to give every name its own program
+		*/
+		std::error_code EnableHotReload(bool enable)
+		{
+			if (!enable)
+			{
+				fileWatcher.reset();
+				for (auto iter = compilingShaders.begin(); iter != compilingShaders.end(); iter++)
+				{
+					(*iter)->CancelReload();
+				}
+
+				for (auto iter = linkingPrograms.begin(); iter != linkingPrograms.end(); iter++)
+				{
+					(*iter)->CancelRelink();
+				}
+				compilingShaders.clear();
+				waitingPrograms.clear();
+				linkingPrograms.clear();
+				std::lock_guard<std::mutex> lock(reloadMutex);
+				fileDependents.clear();
+				shaderRoots.clear();
+				reloadedSources.clear();
+				return error_t::success;
+			}
+
+			if (fileWatcher != nullptr)
+			{
+				return error_t::success;
+			}
+
+			fileWatcher.reset(new fileWatcher_t());
+			std::error_code result = fileWatcher->Start([this](const std::string& filePath) { ReadChangedFile(filePath); });
+			if (result)
+			{
+				fileWatcher.reset();
+				return result;
+			}
+
+			WatchShaderFiles();
+			return error_t::success;
+		}
+
+		/*
+		* apply the shader edits the watcher has picked up. call it once a frame, at the frame boundary, from the
+		* thread that owns the context. only the shaders that depend on a changed file are compiled again and only
+		* the programs that use them are relinked. new versions are built next to the old ones and swapped in by a
+		* later call once the driver is done with them, so the render loop never waits on a compile and a program
+		* never changes halfway through a frame. a shader or program that fails keeps its last good version and
+		* its diagnostics are reported. outReloaded gets every program that was swapped. returns the first failure
+		*/
+		std::error_code UpdateHotReload(std::vector<shaderProgram_t*>& outReloaded)
+		{
+			if (fileWatcher == nullptr)
+			{
+				return error_t::success;
+			}
+
+			std::error_code firstFailure;
+
+			//swap in the programs that finished linking
+			for (auto iter = linkingPrograms.begin(); iter != linkingPrograms.end();)
+			{
+				shaderProgram_t* program = *iter;
+				if (!program->IsRelinkReady())
+				{
+					++iter;
+					continue;
+				}
+
+				iter = linkingPrograms.erase(iter);
+				GLuint previousHandle = program->handle;
+				std::error_code result = program->FinishRelink();
+				if (result)
+				{
+					ReportDiagnostics(program->diagnostics);
+					firstFailure = firstFailure ? firstFailure : result;
+					continue;
+				}
+
+				if (program->separable)
+				{
+					ForgetPipelines(previousHandle);
+				}
+
+				else
+				{
+					RekeyProgram(program);
+				}
+				ShareBlocks(program);
+				outReloaded.push_back(program);
+
+				//the binary on disk is of the old version now, so the new one is written over it
+				if (program->binaryRequested && std::find(pendingBinaries.begin(), pendingBinaries.end(), program) == pendingBinaries.end())
+				{
+					pendingBinaries.push_back(program);
+				}
+			}
+
+			//shaders that finished compiling take over from their old versions and the programs using them wait to be relinked
+			std::set<shader_t*> rebuiltShaders;
+			for (auto iter = compilingShaders.begin(); iter != compilingShaders.end();)
+			{
+				shader_t* shader = *iter;
+				if (!shader->IsReloadReady())
+				{
+					++iter;
+					continue;
+				}
+
+				iter = compilingShaders.erase(iter);
+				std::error_code result = shader->FinishReload();
+				if (result)
+				{
+					ReportDiagnostics(shader->diagnostics);
+					firstFailure = firstFailure ? firstFailure : result;
+					continue;
+				}
+
+				rebuiltShaders.insert(shader);
+				WatchShader(*shader, true);
+			}
+
+			std::vector<shaderProgram_t*> allPrograms;
+			for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end() && !rebuiltShaders.empty(); iter++)
+			{
+				allPrograms.push_back(iter->second.get());
+			}
+
+			for (auto iter = separableStages.begin(); iter != separableStages.end() && !rebuiltShaders.empty(); iter++)
+			{
+				allPrograms.push_back(iter->second.get());
+			}
+
+			for (size_t programIter = 0; programIter < allPrograms.size(); programIter++)
+			{
+				shaderProgram_t* program = allPrograms[programIter];
+				for (size_t shaderIter = 0; shaderIter < program->shaders.size(); shaderIter++)
+				{
+					if (rebuiltShaders.find(program->shaders[shaderIter].get()) != rebuiltShaders.end())
+					{
+						waitingPrograms.insert(program);
+						break;
+					}
+				}
+			}
+
+			//start compiling the edits the watcher thread has read since the last call
+			std::vector<reloadedSource_t> sources;
+			{
+				std::lock_guard<std::mutex> lock(reloadMutex);
+				sources.swap(reloadedSources);
+			}
+
+			for (size_t iterator = 0; iterator < sources.size(); iterator++)
+			{
+				reloadedSource_t& reloaded = sources[iterator];
+				auto shader = shaders.find(reloaded.shaderName);
+				if (shader == shaders.end() || shader->second == nullptr)
+				{
+					continue;
+				}
+
+				if (reloaded.result)
+				{
+					diagnostics.push_back({ shader->second->filePath, 0, severity_t::error, reloaded.result.message() });
+					firstFailure = firstFailure ? firstFailure : reloaded.result;
+					continue;
+				}
+
+				//saving a file without changing it doesn't need a rebuild
+				const shader_t& current = *shader->second;
+				GLuint64 latestHash = (current.pendingHandle != 0) ? HashBuffer(current.pendingBuffer.data(), current.pendingBuffer.size()) : current.contentHash;
+				if (HashBuffer(reloaded.source.data(), reloaded.source.size()) == latestHash)
+				{
+					continue;
+				}
+
+				std::error_code result = shader->second->BeginReload(std::move(reloaded.source), std::move(reloaded.chunks));
+				if (result)
+				{
+					firstFailure = firstFailure ? firstFailure : result;
+					continue;
+				}
+				compilingShaders.insert(shader->second.get());
+			}
+
+			//link the programs that were waiting once none of their shaders are compiling any more
+			for (auto iter = waitingPrograms.begin(); iter != waitingPrograms.end();)
+			{
+				shaderProgram_t* program = *iter;
+				bool shaderCompiling = false;
+				for (size_t shaderIter = 0; shaderIter < program->shaders.size() && !shaderCompiling; shaderIter++)
+				{
+					shaderCompiling = compilingShaders.find(program->shaders[shaderIter].get()) != compilingShaders.end();
+				}
+
+				if (shaderCompiling)
+				{
+					++iter;
+					continue;
+				}
+
+				iter = waitingPrograms.erase(iter);
+				std::error_code result = program->BeginRelink();
+				if (result)
+				{
+					firstFailure = firstFailure ? firstFailure : result;
+					continue;
+				}
+				linkingPrograms.insert(program);
+			}
+
+			if (!outReloaded.empty())
+			{
+				WriteBackBinaries();
+			}
+
+			//only trim once nothing is in flight, or the shaders a pending link needs would be compiled twice
+			if (!outReloaded.empty() && compilingShaders.empty() && waitingPrograms.empty() && linkingPrograms.empty())
+			{
+				TrimIfLean();
+			}
+			return firstFailure;
+		}
+
+		/*
+		* whether any reloaded shader or program is still being built
+		*/
+		bool IsHotReloadPending() const
+		{
+			return !compilingShaders.empty() || !waitingPrograms.empty() || !linkingPrograms.empty();
+		}
+
+	private:
+
+		/*
+		* the key binds are tracked under: the one given to SetCurrentContext, or else the current native context
+		*/
+		const void* BindContext() const
+		{
+			return (currentContext != nullptr) ? currentContext : CurrentNativeContext();
+		}
+
+		/*
+		* get a loaded shader by name, bringing it back first if memory lean mode released it
+		*/
+		std::shared_ptr<shader_t> AcquireShader(const GLchar* shaderName)
+		{
+			if (shaderName == nullptr)
+			{
+				return nullptr;
+			}
+
+			auto existing = shaders.find(shaderName);
+			if (existing == shaders.end() || existing->second == nullptr)
+			{
+				return nullptr;
+			}
+
+			if (existing->second->Restore())
+			{
+				ReportDiagnostics(existing->second->diagnostics);
+			}
+			return existing->second;
+		}
+
+		/*
+		* point the blocks of a newly loaded program at the layouts already known to the manager so programs
+		* that declare the same block share one layout. then let the application know about them
+		*/
+		void ShareBlocks(shaderProgram_t* program)
+		{
+			for (size_t iterator = 0; iterator < program->blocks.size(); iterator++)
 			{
-				for (size_t iterator = 0; iterator < shaders.size(); iterator++)
+				block_t& block = program->blocks[iterator];
+				auto existing = blockLayouts.find(block.layout->layoutHash);
+				if (existing != blockLayouts.end())
 				{
-					if (shaders[iterator] != nullptr)
-					{
-						glAttachShader(handle, shaders[iterator]->handle);
-					}
+					block.layout = existing->second;
 				}
 
-				// specify vertex input attributes
-				for (size_t i = 0; i < inputs.size(); ++i)
+				else
 				{
-					glBindAttribLocation(handle, (GLuint)i, inputs[i].c_str());
+					blockLayouts.insert(std::make_pair(block.layout->layoutHash, block.layout));
 				}
+			}
+
+			if (shaderBlocksEvent != nullptr)
+			{
+				shaderBlocksEvent(program->handle, program->blocks);
+			}
+		}
+
+		/*
+		* release whatever memory lean mode allows and add it to the running total
+		*/
+		void TrimIfLean()
+		{
+			if (memoryLean)
+			{
+				memoryReport_t report;
+				TrimShaders(report);
+				memorySaved.shaderObjectsDeleted += report.shaderObjectsDeleted;
+				memorySaved.sourceBytesReleased += report.sourceBytesReleased;
+			}
+		}
+
+		/*
+		* add diagnostics to the list of failures
+		*/
+		void ReportDiagnostics(const std::vector<diagnostic_t>& newDiagnostics)
+		{
+			diagnostics.insert(diagnostics.end(), newDiagnostics.begin(), newDiagnostics.end());
+		}
+
+		/*
+		* keep the diagnostics of a shader that failed to compile then delete it
+		*/
+		void ReportFailure(shader_t* failedShader)
+		{
+			diagnostics.insert(diagnostics.end(), failedShader->diagnostics.begin(), failedShader->diagnostics.end());
+			failedShader->Shutdown();
+			delete failedShader;
+		}
+
+		/*
+		* keep the diagnostics of a program that failed to link then delete it. its shaders are left alone
+		* since they can be shared with other programs
+		*/
+		void ReportFailure(shaderProgram_t* failedProgram)
+		{
+			diagnostics.insert(diagnostics.end(), failedProgram->diagnostics.begin(), failedProgram->diagnostics.end());
+			glDeleteProgram(failedProgram->handle);
+			delete failedProgram;
+		}
 
-				// specify pixel shader outputs
-				for (size_t i = 0; i < outputs.size(); ++i)
+		/*
+		* convert the given string to a shader type
+		*/
+		GLuint StringToShaderType(const GLchar* typeString) const
+		{
+			if (typeString != nullptr)
+			{
+				if (!strcmp(typeString, "Vertex"))
 				{
-					glBindFragDataLocation(handle, (GLuint)i, outputs[i].c_str());
+					return gl_vertex_shader;
 				}
 
-				if (saveBinary)
+				if (!strcmp(typeString, "Fragment"))
 				{
-					glProgramParameteri(handle, gl_program_binary_retrievable_hint, GL_TRUE);
+					return gl_fragment_shader;
 				}
 
-				glLinkProgram(handle);
-				glGetProgramiv(handle, gl_link_status, &successful);
-
-				if (!successful)
+				if (!strcmp(typeString, "Geometry"))
 				{
-					glGetProgramInfoLog(handle, sizeof(errorLog), 0, errorLog);
-					return error_t::shaderProgramLinkFailed;
+					return gl_geometry_shader;
 				}
 
-				//if a shader successfully compiles then it will add itself to storage
-				if (saveBinary)
+				if (!strcmp(typeString, "Tessellation Control"))
 				{
-					GLsizei binarySize = 0;
-					glGetProgramiv(handle, gl_program_binary_length, &binarySize);
-
-					void* buffer = (void*)malloc((size_t)binarySize);
-					GLenum binaryFormat = NULL;
-
-					glGetProgramBinary(handle, binarySize, NULL, &binaryFormat, buffer);
-
-					GLchar* path = new GLchar[(size_t)binarySize];
-					memset(path, 1, (size_t)binarySize);
-
-					strcpy(path, defaultBinaryPath.c_str());
-					strcat(path, name);
-					strcat(path, defaultProrgamBinaryExtension.c_str());
+					return gl_tess_control_shader;
+				}
 
-					FILE* file = fopen(path, "wb");
-					fprintf(file, "%s\n", name);
-					fprintf(file, "%i\n", binarySize);
-					fprintf(file, "%i\n", binaryFormat);
-					fwrite(buffer, (size_t)binarySize, 1, file);
-					fclose(file);
-					delete[] path;
+				if (!strcmp(typeString, "Tessellation Evaluation"))
+				{
+					return gl_tess_evaluation_shader;
 				}
-				compiled = true;
-				return error_t::success;
+
+				return GL_FALSE;
 			}
-			return error_t::shaderProgramAlreasyCompiled;
+			return GL_FALSE;
 		}
 
-		const GLchar*										name;				/**< The name of the shader program */
-		GLuint												handle;				/**< The OpenGL handle to the shader program */
-		GLboolean											compiled;			/**< Whether the shader program has been linked successfully */
-		std::vector< std::string >							inputs;				/**< The inputs of the shader program as a vector of strings */
-		std::vector< std::string >							outputs;			/**< The outputs of the shader program as a vector of strings */
-		std::vector< std::unique_ptr<shader_t> >			shaders;			/**< The components that the shader program is comprised of as a vector */
-	};
-
-	class shaderManager
-	{
-	public:
-
-		std::map<std::string, std::unique_ptr<shaderProgram_t>>			shaderPrograms;		/**< All loaded shader programs */
-		std::map<std::string, std::unique_ptr<shader_t>>				shaders;			/**< All loaded shaders*/
+		/*
+		* convert the given string to a shader type. a type ending in "Library" (FragmentLibrary for example) is
+		* a library shader: it has no main and is attached next to the main shader of its stage, so common code is
+		* compiled once instead of being pasted into every source. the main shader declares the functions it uses
+		*/
+		GLuint StringToShaderType(const GLchar* typeString, bool& outLibrary) const
+		{
+			outLibrary = false;
+			if (typeString == nullptr)
+			{
+				return GL_FALSE;
+			}
 
-		shaderManager() {}
-		~shaderManager() {}
+			std::string type = typeString;
+			const std::string suffix = "Library";
+			if (type.size() > suffix.size() && type.compare(type.size() - suffix.size(), suffix.size(), suffix) == 0)
+			{
+				outLibrary = true;
+				type.erase(type.size() - suffix.size());
+			}
+			return StringToShaderType(type.c_str());
+		}
 
 		/*
-		* shuts down TinyShaders. deletes all OpenGL shaders and shader programs
-		* as well as calling shutdown on all shader and programs and clears all vectors.
+		* convert the given shader type to a string
 		*/
-		void Shutdown()
+		const GLchar* ShaderTypeToString(GLuint shaderType) const
 		{
+			switch (shaderType)
+			{
+			case gl_vertex_shader:
+			{
+				return "Vertex";
+			}
 
-			for (auto iter = shaders.begin(); iter != shaders.end(); iter++)
-			{	
-				iter->second->Shutdown();
-				iter->second.release();
+			case gl_fragment_shader:
+			{
+				return "Fragment";
 			}
-			for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+
+			case gl_geometry_shader:
 			{
-				
-				iter->second->Shutdown();
-				iter->second.release();
+				return "Geometry";
+			}
+
+			case gl_tess_control_shader:
+			{
+				return "Tessellation Control";
 			}
 
-			
+			case gl_tess_evaluation_shader:
+			{
+				return "Tessellation Evaluation";
+			}
 
-			shaderPrograms.clear();
-			shaders.clear();
+			default:
+			{
+				return NULL;
+			}
+			}
+
+			return nullptr;
 		}
 
 		/*
-		* load an OpenGL shader
+		* read every program of a config file without building anything
 		*/
-		std::error_code LoadShader(const GLchar* name, shader_t* outShader, const GLchar* shaderFile, GLuint shaderType)
+		std::error_code ReadProgramConfigFile(const GLchar* configPath, bool saveBinary, std::vector<queuedProgram_t>& outQueued)
 		{
-			if (name != nullptr)
+			FILE* pConfigFile = OpenFile(configPath, "r");
+			if (!pConfigFile)
 			{
-				if (shaderType <= 5)
+				return error_t::invalidConfigFile;
+			}
+
+			GLuint numPrograms = 0;
+			GLuint count = 0;
+			GLchar line[255] = {};
+			GLchar token[255] = {};
+			GLchar priority[255] = {};
+
+			//get the total number of shader programs
+			fscanf(pConfigFile, "%i\n", &numPrograms);
+			for (GLuint programIter = 0; programIter < numPrograms; programIter++)
+			{
+				queuedProgram_t queuedProgram;
+				queuedProgram.saveBinary = saveBinary;
+				queuedProgram.priority = defaultPriority;
+
+				//get the name of the shader program and its priority if it has one
+				GLint numTokens = (fscanf(pConfigFile, "%254[^\n]\n", line) == 1) ? sscanf(line, "%254s %254s", token, priority) : 0;
+				if (numTokens < 1)
 				{
-					shader_t* newShader = new shader_t(name, shaderType, shaderFile);
-					if (newShader->isCompiled)
-					{
-						shaders.insert(std::make_pair(name, std::move(newShader)));
-						outShader = shaders[name].get();
-						return error_t::success;
-					}
-					return error_t::shaderCompileFailed;
+					break;
 				}
-				return error_t::invalidShaderType;
+				queuedProgram.name = token;
+
+				if (numTokens == 2 && !StringToPriority(priority, queuedProgram.priority))
+				{
+					diagnostic_t diagnostic = { configPath, 0, severity_t::warning, queuedProgram.name + ": unknown priority " + priority };
+					ReportDiagnostics(std::vector<diagnostic_t>(1, diagnostic));
+				}
+
+				auto priorityOverride = programPriorities.find(queuedProgram.name);
+				if (priorityOverride != programPriorities.end())
+				{
+					queuedProgram.priority = priorityOverride->second;
+				}
+
+				//get all inputs
+				fscanf(pConfigFile, "%i\n", &count);
+				for (GLuint iterator = 0; iterator < count; iterator++)
+				{
+					fscanf(pConfigFile, "%254s\n", token);
+					queuedProgram.inputs.push_back(token);
+				}
+
+				//get all outputs
+				fscanf(pConfigFile, "%i\n", &count);
+				for (GLuint iterator = 0; iterator < count; iterator++)
+				{
+					fscanf(pConfigFile, "%254s\n", token);
+					queuedProgram.outputs.push_back(token);
+				}
+
+				//get the name, type and file path of every shader
+				fscanf(pConfigFile, "%i\n", &count);
+				for (GLuint iterator = 0; iterator < count; iterator++)
+				{
+					queuedShader_t queuedShader;
+					fscanf(pConfigFile, "%254s\n", token);
+					queuedShader.name = token;
+					fscanf(pConfigFile, "%254s\n", token);
+					queuedShader.type = token;
+					fscanf(pConfigFile, "%254s\n", token);
+					queuedShader.path = token;
+					queuedShader.size = 0;
+					GetFileSize(token, queuedShader.size);
+					queuedProgram.shaders.push_back(queuedShader);
+				}
+				outQueued.push_back(std::move(queuedProgram));
 			}
-			return error_t::invalidShaderName;
+			fclose(pConfigFile);
+			return error_t::success;
 		}
 
 		/*
-		* loads all shaders and shader programs specified in a custom configuration file
+		* compile the shaders of a program read from a config file and link it. what gets made is recorded in the
+		* job, if there is one, so it can be released if the job is cancelled
 		*/
-		std::error_code LoadShaderProgramsFromConfigFile(const GLchar* configPath, std::vector<shaderProgram_t*>& outPrograms, bool saveBinary = false)
+		void BuildQueuedProgram(const queuedProgram_t& queuedProgram, std::vector<shaderProgram_t*>& outPrograms, loadJob_t* job)
 		{
-			FILE* pConfigFile = fopen(configPath, "r");
-			GLuint numInputs = 0;
-			GLuint numOutputs = 0;
-			GLuint numPrograms = 0;
-			GLuint numShaders = 0;
-			GLuint iterator = 0;
+			//this is an anti-trolling measure. If a shader with the same name already exists the don't bother making a new one.
+			if (shaderPrograms.find(queuedProgram.name) != shaderPrograms.end())
+			{
+				for (size_t shaderIter = 0; shaderIter < queuedProgram.shaders.size() && job != nullptr; shaderIter++)
+				{
+					job->bytesTotal -= queuedProgram.shaders[shaderIter].size;
+				}
+				return;
+			}
 
-			std::vector< std::string > inputs, outputs, paths, names;
-			std::vector< std::unique_ptr<shader_t>> newShaders;
-			if (pConfigFile)
+			std::vector<std::shared_ptr<shader_t>> newShaders;
+			for (size_t shaderIter = 0; shaderIter < queuedProgram.shaders.size(); shaderIter++)
 			{
-				//get the total number of shader programs
-				fscanf(pConfigFile, "%i\n", &numPrograms);
+				const queuedShader_t& queuedShader = queuedProgram.shaders[shaderIter];
 
-				for (GLuint programIter = 0;
-					programIter < numPrograms;
-					programIter++, paths.clear(), inputs.clear(), outputs.clear(), names.clear(), newShaders.clear())
+				//if the shader hasn't been loaded already then make a new one
+				if (shaders.find(queuedShader.name) == shaders.end())
 				{
-					//get the name of the shader program 
-					GLchar* programName = new GLchar[255];
-					fscanf(pConfigFile, "%s\n", programName);
-
-					//this is an anti-trolling measure. If a shader with the same name already exists the don't bother making a new one.
-					if (shaderPrograms.find(programName) == shaderPrograms.end())
+					bool isLibrary = false;
+					GLuint type = StringToShaderType(queuedShader.type.c_str(), isLibrary);
+					//shaders keep a pointer to their path so it has to outlive the queued program
+					const GLchar* shaderPath = shaderFilePaths.insert(queuedShader.path).first->c_str();
+					shader_t* newShader = new shader_t(queuedShader.name.c_str(), type, shaderPath);
+					newShader->isLibrary = isLibrary;
+					if (job != nullptr)
 					{
-						//get the number of shader inputs
-						fscanf(pConfigFile, "%i\n", &numInputs);
+						job->bytesRead += queuedShader.size;
+					}
 
-						//get all inputs
-						for (iterator = 0; iterator < numInputs; iterator++)
+					if (newShader->isCompiled)
+					{
+						auto inserted = shaders.insert(std::make_pair(queuedShader.name, std::shared_ptr<shader_t>(newShader))).first;
+						inserted->second->name = inserted->first.c_str();
+						WatchShader(*newShader, false);
+						newShaders.push_back(inserted->second);
+						if (job != nullptr)
 						{
-							GLchar* input = new GLchar[255];
-							fscanf(pConfigFile, "%s\n", input);
-							inputs.push_back(input);
+							job->shaderNames.push_back(queuedShader.name);
 						}
+					}
+
+					else
+					{
+						ReportFailure(newShader);
+					}
+				}
 
-						//get the number of shader outputs
-						fscanf(pConfigFile, "%i\n", &numOutputs);
+				else
+				{
+					//if shader already exists then add an existing one from storage. it might have been released by memory lean mode.
+					//its file isn't read for this job so it stops counting towards the job's bytes
+					newShaders.push_back(AcquireShader(queuedShader.name.c_str()));
+					if (job != nullptr)
+					{
+						job->bytesTotal -= queuedShader.size;
+					}
+				}
+			}
 
-						//get all outputs
-						for (iterator = 0; iterator < numOutputs; iterator++)
-						{
-							GLchar* output = new GLchar[255];
-							fscanf(pConfigFile, "%s\n", output);
-							outputs.push_back(output);
-						}
+			//a program with the same content as one already loaded is the same program under another name.
+			//the name is still reported ready so every program in the config file gets its event
+			if (ShareIdenticalProgram(queuedProgram.name, ProgramContentKey(queuedProgram.inputs, queuedProgram.outputs, newShaders), outPrograms))
+			{
+				if (job != nullptr)
+				{
+					job->programs.push_back(outPrograms.back());
+					job->programNames.push_back(queuedProgram.name);
+				}
 
-						//get number of shaders
-						fscanf(pConfigFile, "%i\n", &numShaders);
+				if (programReadyEvent != nullptr)
+				{
+					programReadyEvent(outPrograms.back());
+				}
+				return;
+			}
 
-						for (GLuint iterator = 0; iterator < numShaders; iterator++)
-						{
-							GLchar* shaderName = new GLchar[255];
-							GLchar* shaderPath = new GLchar[255];
-							GLchar* shaderType = new GLchar[255];
+			shaderProgram_t* newShaderProgram = new shaderProgram_t(queuedProgram.name.c_str(), queuedProgram.inputs, queuedProgram.outputs,
+				std::move(newShaders), queuedProgram.saveBinary);
+			if (newShaderProgram->compiled)
+			{
+				newShaderProgram->priority = queuedProgram.priority;
+				auto inserted = AddProgram(queuedProgram.name, std::shared_ptr<shaderProgram_t>(newShaderProgram), newShaderProgram->MakeContentKey());
+				inserted->second->name = inserted->first.c_str();
+				outPrograms.push_back(newShaderProgram);
+				ShareBlocks(newShaderProgram);
+				if (job != nullptr)
+				{
+					job->programs.push_back(newShaderProgram);
+					job->programNames.push_back(queuedProgram.name);
+				}
 
-							//get shader name
-							fscanf(pConfigFile, "%s\n", shaderName);
+				if (programReadyEvent != nullptr)
+				{
+					programReadyEvent(newShaderProgram);
+				}
+			}
 
-							//if the shader hasn't been loaded already then make a new one
-							if (shaders.find(shaderName) == shaders.end())
-							{
-								//get type
-								fscanf(pConfigFile, "%s\n", shaderType);
-								//get file path
-								fscanf(pConfigFile, "%s\n", shaderPath);
-
-								shader_t* newShader = new shader_t(shaderName, StringToShaderType((const char*)shaderType), shaderPath);
-								if (newShader->isCompiled)
-								{
-									shaders.insert(std::make_pair(shaderName, std::move(newShader)));
-									newShaders.push_back(std::move(shaders[shaderName]));
-								}
-							}
+			else
+			{
+				ReportFailure(newShaderProgram);
+			}
+		}
 
-							else
-							{
-								//tell scanf to skip a couple lines
-								fscanf(pConfigFile, "%*[^\n]\n %*[^\n]\n");
-								//if shader already exists then add an existing one from storage, it should already be compiled
-								newShaders.push_back(std::move(shaders[shaderName]));
-							}
-						}
+		/*
+		* read a program binary file: the program name, the size (followed by lz4 if compressed) and the format on a
+		* line each, then the binary. called from worker threads so it only touches the file and outBinary
+		*/
+		static void ReadProgramBinary(const GLchar* binaryPath, programBinary_t& outBinary)
+		{
+			FILE* binaryFile = OpenFile(binaryPath, "rb");
+			if (binaryFile == nullptr)
+			{
+				outBinary.result = error_t::invalidFilePath;
+				return;
+			}
 
-						shaderProgram_t* newShaderProgram = new shaderProgram_t(programName, inputs, outputs, std::move(newShaders), saveBinary);
-						if (newShaderProgram->compiled)
-						{
-							shaderPrograms.insert(std::make_pair(programName, std::move(newShaderProgram)));
-							outPrograms.push_back(shaderPrograms[programName].get());
-						}
-					}
+			//the header lines are read one newline at a time. skipping all whitespace could eat the start of the binary
+			GLchar binaryName[255] = {};
+			GLuint binarySize = 0;
+			GLuint binaryFormat = 0;
+			bool compressed = false;
+			if (fscanf(binaryFile, "%254s", binaryName) != 1 || fgetc(binaryFile) != '\n' ||
+				fscanf(binaryFile, "%u", &binarySize) != 1 || !ReadPayloadCodec(binaryFile, compressed) ||
+				fscanf(binaryFile, "%u", &binaryFormat) != 1 || fgetc(binaryFile) != '\n' || binarySize == 0 ||
+				!PayloadFits(binaryFile, binarySize, compressed))
+			{
+				fclose(binaryFile);
+				outBinary.result = error_t::invalidProgramBinary;
+				return;
+			}
+
+			//compressed binaries are decoded here on the worker, a chunk at a time as they are read
+			outBinary.name = binaryName;
+			outBinary.format = binaryFormat;
+			outBinary.data.resize(binarySize);
+			bool read = compressed ? ReadCompressed(binaryFile, outBinary.data.data(), binarySize) :
+				fread(outBinary.data.data(), binarySize, 1, binaryFile) == 1;
+			outBinary.result = read ? std::error_code(error_t::success) : std::error_code(error_t::invalidProgramBinary);
+			fclose(binaryFile);
+		}
+
+		/*
+		* fetch the binaries of the programs that asked for one and hand them to the writer thread as one batch.
+		* programs the driver is still linking in the background wait for a later call
+		*/
+		void WriteBackBinaries()
+		{
+			binaryWriter_t::batch_t batch;
+			for (auto iter = pendingBinaries.begin(); iter != pendingBinaries.end();)
+			{
+				shaderProgram_t* program = *iter;
+				if (program->handle != 0 && !IsCompletionReady(program->handle, true))
+				{
+					iter++;
+					continue;
 				}
-				fclose(pConfigFile);
-				return error_t::success;
+
+				programBinary_t binary;
+				if (program->handle != 0 && !program->RetrieveBinary(binary))
+				{
+					std::string binaryPath = program->BinaryPath(binary.format);
+					batch.push_back(std::make_pair(binaryPath, std::move(binary)));
+				}
+				program->binaryRequested = false;
+				iter = pendingBinaries.erase(iter);
 			}
-			else
+			binaryWriter.Queue(batch);
+		}
+
+		/*
+		* make a load job for the given programs. it isn't queued for UpdateLoading yet
+		*/
+		static std::shared_ptr<loadJob_t> MakeLoadJob(std::vector<queuedProgram_t>& queuedPrograms)
+		{
+			std::shared_ptr<loadJob_t> job(new loadJob_t());
+			job->programsTotal = (GLuint)queuedPrograms.size();
+			for (size_t programIter = 0; programIter < queuedPrograms.size(); programIter++)
 			{
-				return error_t::invalidConfigFile;
+				for (size_t shaderIter = 0; shaderIter < queuedPrograms[programIter].shaders.size(); shaderIter++)
+				{
+					job->bytesTotal += queuedPrograms[programIter].shaders[shaderIter].size;
+				}
+				job->queue.push_back(std::move(queuedPrograms[programIter]));
 			}
+			return job;
 		}
 
 		/*
-		* loads shader program binaries using a config file
+		* make a job for a load that was over before it returned, so every bulk load can be followed the same way
 		*/
-		std::error_code LoadProgramBinariesFromConfigFile(const GLchar* configPath, std::vector<shaderProgram_t*>& outPrograms)
+		static std::shared_ptr<loadJob_t> FinishedLoadJob(const std::vector<shaderProgram_t*>& programs, GLuint programsTotal, size_t bytesRead)
+		{
+			std::shared_ptr<loadJob_t> job(new loadJob_t());
+			job->programs = programs;
+			job->programsTotal = programsTotal;
+			job->programsDone = programsTotal;
+			job->bytesTotal = bytesRead;
+			job->bytesRead = bytesRead;
+			job->Complete();
+			return job;
+		}
+
+		/*
+		* give back everything a cancelled job made. programs and shaders that other loads share are kept
+		*/
+		void ReleaseJob(loadJob_t& job)
 		{
-			//open a file stream to binaries.txt
-			GLuint numBinaries;
-			FILE* configFile = nullptr;
-			if (configPath != nullptr)
+			//a program's name points at the key it was added under, which may be one of the keys going away
+			std::set<shaderProgram_t*> unnamedPrograms;
+			for (size_t iterator = 0; iterator < job.programNames.size(); iterator++)
 			{
-				configFile = fopen(configPath, "r");
-				if (configFile != nullptr)
+				auto program = shaderPrograms.find(job.programNames[iterator]);
+				if (program == shaderPrograms.end())
 				{
-					fscanf(configFile, "%i", &numBinaries);
-					fscanf(configFile, "%*[^\n]\n %*[^\n]\n"); //skip a couple lines
-					for (unsigned int iter = 0; iter < numBinaries; iter++)
-					{
-						GLchar binaryPath[255];
-						fscanf(configFile, "%s \n", binaryPath);
-
-						FILE* binaryFile = fopen(binaryPath, "rb");
-						//std::ifstream file;
-						GLchar binaryName[255];
-						GLuint binarySize = 0;
-						GLuint size = 0;
-						GLuint binaryFormat = 0;
-
-						fscanf(binaryFile, "%s \n", binaryName);
-						fscanf(binaryFile, "%i \n", &binarySize);
-						fscanf(binaryFile, "%i \n", &binaryFormat);
+					continue;
+				}
 
-						void* binaryBuffer = (void*)malloc((size_t)binarySize);
-						fread(binaryBuffer, (size_t)binarySize, 1, binaryFile);
-						fclose(binaryFile);
+				if (program->second->name == program->first.c_str())
+				{
+					unnamedPrograms.insert(program->second.get());
+				}
+				shaderPrograms.erase(program);
+			}
 
-						//load the buffer into OpenGL
-						GLuint programHandle = glCreateProgram();
-						glProgramBinary(programHandle, binaryFormat, binaryBuffer, binarySize);
-						free(binaryBuffer);
-						GLint isSuccessful = false;
+			std::set<shaderProgram_t*> namedPrograms;
+			std::set<shader_t*> usedShaders;
+			for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+			{
+				//a program another load shares goes by the name that load gave it
+				if (unnamedPrograms.erase(iter->second.get()) != 0)
+				{
+					iter->second->name = iter->first.c_str();
+				}
 
-						glGetProgramiv(programHandle, gl_link_status, &isSuccessful);
+				namedPrograms.insert(iter->second.get());
+				for (size_t shaderIter = 0; shaderIter < iter->second->shaders.size(); shaderIter++)
+				{
+					usedShaders.insert(iter->second->shaders[shaderIter].get());
+				}
+			}
 
-						if (isSuccessful)
-						{
-							//create a program object and load into the list
-							std::unique_ptr<shaderProgram_t> newProgram(new shaderProgram_t(binaryName, programHandle));
-							if (newProgram->compiled)
-							{
-								//only if its successful. release the data if it isnt? or does it remove itself when it goes out of scope?
-								shaderPrograms.insert(std::make_pair(binaryName, std::move(newProgram)));
-								outPrograms.push_back(shaderPrograms[binaryName].get());
-								return error_t::success;
-							}
+			for (auto iter = separableStages.begin(); iter != separableStages.end(); iter++)
+			{
+				for (size_t shaderIter = 0; shaderIter < iter->second->shaders.size(); shaderIter++)
+				{
+					usedShaders.insert(iter->second->shaders[shaderIter].get());
+				}
+			}
 
-							else
-							{
-								shaderProgram_t* toDelete = newProgram.release();
-								delete toDelete;
-								return error_t::shaderProgramLoadFailed;
-							}
-						}
-						return error_t::shaderProgramLoadFailed;
-					}
-					fclose(configFile);
+			for (auto iter = programsByContent.begin(); iter != programsByContent.end();)
+			{
+				if (namedPrograms.find(iter->second.get()) == namedPrograms.end())
+				{
+					ReleaseProgram(*iter->second);
+					iter = programsByContent.erase(iter);
 				}
 
 				else
 				{
-					return error_t::invalidConfigFile;
+					iter++;
 				}
 			}
 
-			else
+			for (size_t iterator = 0; iterator < job.shaderNames.size(); iterator++)
 			{
-				return error_t::invalidFilePath;
+				auto shader = shaders.find(job.shaderNames[iterator]);
+				if (shader == shaders.end() || usedShaders.find(shader->second.get()) != usedShaders.end())
+				{
+					continue;
+				}
+
+				compilingShaders.erase(shader->second.get());
+				{
+					std::lock_guard<std::mutex> lock(reloadMutex);
+					shaderRoots.erase(shader->first);
+					for (auto file = fileDependents.begin(); file != fileDependents.end(); file++)
+					{
+						file->second.erase(shader->first);
+					}
+				}
+				shader->second->Shutdown();
+				shaders.erase(shader);
 			}
+			job.programs.clear();
 		}
 
 		/*
-		* loads shaders from a config file
+		* delete a program nothing refers to anymore. unlike shaderProgram_t::Shutdown its shaders are left alone
+		* since other programs may share them
 		*/
-		std::error_code LoadShadersFromConfigFile(const GLchar* configFile, std::vector<shader_t*>& outShaders)
+		void ReleaseProgram(shaderProgram_t& program)
 		{
-			FILE* pConfigFile = fopen(configFile, "r+");
-			int numShaders = 0;
+			pendingBinaries.erase(std::remove(pendingBinaries.begin(), pendingBinaries.end(), &program), pendingBinaries.end());
+			waitingPrograms.erase(&program);
+			linkingPrograms.erase(&program);
+			program.CancelRelink();
 
-			if (pConfigFile)
+			//GL reuses names, so a later program with the same handle mustn't look bound already
+			for (auto bound = boundPrograms.begin(); bound != boundPrograms.end();)
 			{
-				//get the number of shaders to load
-				fscanf(pConfigFile, "%i\n", &numShaders);
-				GLchar* shaderName;
-				GLchar*	shaderType;
-				GLchar*	shaderPath;
-
-				GLchar empty[255];
-
-				for (int iterator = 0; iterator < numShaders;
-					iterator++, fscanf(pConfigFile, "\n\n"))
+				if (bound->second == program.handle)
 				{
-					shaderName = empty;
-					fscanf(pConfigFile, "%s\n", shaderName);
-
-					//if it doesn't find an existing shader with a matching name then add it. else ignore it
-					if (shaders.find(shaderName) == shaders.end())
-					{
-						shaderType = empty;
-						fscanf(pConfigFile, "%s\n", shaderType);
-
-						shaderPath = empty;
-						fscanf(pConfigFile, "%s\n", shaderPath);
-
-						shader_t* newShader = new shader_t(shaderName, StringToShaderType(shaderType), shaderPath);
-						if (newShader->isCompiled)
-						{
-							shaders.insert(std::make_pair(shaderName, std::move(newShader)));
-							return error_t::success;
-						}
-					}
+					bound = boundPrograms.erase(bound);
 				}
-				return error_t::shaderNotFound;
-			}
 
-			else
-			{
-				return error_t::invalidConfigFile;
+				else
+				{
+					bound++;
+				}
 			}
+			glDeleteProgram(program.handle);
+			program.handle = 0;
+			program.attachedShaders.clear();
+			program.compiled = false;
 		}
 
 		/*
-		* saves all loaded shaders and shader programs to a config file
+		* read a priority written in a config file. returns false if the string isn't one
 		*/
-		std::error_code SaveShaderProgramsToConfigFile(const GLchar* fileName)
+		static bool StringToPriority(const GLchar* priorityString, programPriority_t& outPriority)
 		{
-			//write total amount of shaders
-			FILE* pConfigFile = fopen(fileName, "w+");
-
-			if (pConfigFile)
+			const programPriority_t priorities[] = { programPriority_t::critical, programPriority_t::normal, programPriority_t::background };
+			for (size_t iterator = 0; iterator < 3; iterator++)
 			{
-				fprintf(pConfigFile, "%i\n\n", (GLint)shaderPrograms.size());
-
-				for (auto iter = shaderPrograms.begin(); iter != shaderPrograms.end(); iter++)
+				if (strcmp(priorityString, PriorityToString(priorities[iterator])) == 0)
 				{
-					//write program name
-					fprintf(pConfigFile, "%s\n", iter->second.get()->name);
-
-					//write number of inputs
-					fprintf(pConfigFile, "%i\n", (GLint)iter->second.get()->inputs.size());
-
-					//write inputs
-					for (size_t inputIter = 0; inputIter < iter->second.get()->inputs.size(); inputIter++)
-					{
-						fprintf(pConfigFile, "%s\n", iter->second.get()->inputs[inputIter].c_str());
-					}
-
-					fprintf(pConfigFile, "%i\n", (GLint)iter->second.get()->outputs.size());
-
-					//write outputs
-					for (size_t outputIter = 0; outputIter < iter->second.get()->outputs.size(); outputIter++)
-					{
-						fprintf(pConfigFile, "%s\n", iter->second.get()->outputs[outputIter].c_str());
-					}
-
-					//write number of shaders
-					fprintf(pConfigFile, "%i\n", (GLint)iter->second.get()->shaders.size());
+					outPriority = priorities[iterator];
+					return true;
+				}
+			}
+			return false;
+		}
 
-					for (size_t shaderIter = 0; shaderIter < iter->second.get()->shaders.size(); shaderIter++)
-					{
-						//write shader name
-						fprintf(pConfigFile, "%s\n", iter->second.get()->shaders[shaderIter]->name);
+		static const GLchar* PriorityToString(programPriority_t priority)
+		{
+			switch (priority)
+			{
+				case programPriority_t::critical:
+				{
+					return "critical";
+				}
 
-						//write shader type
-						fprintf(pConfigFile, "%s\n", ShaderTypeToString(iter->second.get()->shaders[shaderIter]->type));
+				case programPriority_t::background:
+				{
+					return "background";
+				}
 
-						//write shader file path
-						fprintf(pConfigFile, "%s\n", iter->second.get()->shaders[shaderIter]->filePath);
-					}
+				default:
+				{
+					return "normal";
 				}
-				fclose(pConfigFile);
-				return error_t::success;
 			}
+		}
 
-			else
+		/*
+		* the content key of a program that is about to be made from the given shaders
+		*/
+		static GLuint64 ProgramContentKey(const std::vector<std::string>& inputs, const std::vector<std::string>& outputs,
+			const std::vector<std::shared_ptr<shader_t>>& programShaders)
+		{
+			std::vector<std::pair<GLuint, GLuint64>> stages;
+			for (size_t iterator = 0; iterator < programShaders.size(); iterator++)
 			{
-				return error_t::invalidConfigFile;
+				if (programShaders[iterator] != nullptr)
+				{
+					stages.push_back(std::make_pair(programShaders[iterator]->type, programShaders[iterator]->contentHash));
+				}
 			}
+			return shaderProgram_t::MakeContentKey(inputs, outputs, stages);
 		}
 
 		/*
-		* builds a new OpenGL shader program from already loaded shaders
+		* if a program with the given content is already loaded, add the name to it instead of linking it again.
+		* nothing is shared while hot reload is on, since the names can be built from different files that
+		* stop matching as soon as one of them is edited
 		*/
-		std::error_code BuildProgramFromShaders(const GLchar* shaderName,
-			const std::vector< std::string >& inputs,
-			const std::vector< std::string >& outputs,
-			const GLchar* vertexShaderName,
-			const GLchar* fragmentShaderName,
-			const GLchar* geometryShaderName,
-			const GLchar* tessContShaderName,
-			const GLchar* tessEvalShaderName,
-			bool saveBinary = false)
+		bool ShareIdenticalProgram(const std::string& programName, GLuint64 contentKey, std::vector<shaderProgram_t*>& outPrograms)
 		{
-				std::vector< std::unique_ptr<shader_t>> reusedShaders;
-				reusedShaders.push_back(std::move(shaders[vertexShaderName]));
-				reusedShaders.push_back(std::move(shaders[fragmentShaderName]));
-				reusedShaders.push_back(std::move(shaders[geometryShaderName]));
-				reusedShaders.push_back(std::move(shaders[tessContShaderName]));
-				reusedShaders.push_back(std::move(shaders[tessEvalShaderName]));
+			if (fileWatcher != nullptr)
+			{
+				return false;
+			}
 
-				std::unique_ptr<shaderProgram_t> newShaderProgram(new shaderProgram_t(shaderName, inputs, outputs, std::move(reusedShaders), saveBinary));
-				if (newShaderProgram.get()->compiled)
-				{
-					shaderPrograms.insert(std::make_pair(shaderName, std::move(newShaderProgram)));
-				}
+			auto identical = programsByContent.find(contentKey);
+			if (identical == programsByContent.end())
+			{
+				return false;
+			}
 
-				return error_t::success;
+			shaderPrograms.insert(std::make_pair(programName, identical->second));
+			outPrograms.push_back(identical->second.get());
+			return true;
 		}
 
 		/*
-		* loads an OpengL shader from char buffer
+		* add a newly linked program under its name and content key
 		*/
-		std::error_code LoadShaderFromBuffer(const char* name, const GLchar* buffer, GLuint shaderType)
+		std::map<std::string, std::shared_ptr<shaderProgram_t>>::iterator AddProgram(const std::string& programName, std::shared_ptr<shaderProgram_t> program, GLuint64 contentKey)
 		{
-			if (buffer != nullptr)
+			program->contentKey = contentKey;
+			programsByContent.insert(std::make_pair(contentKey, program));
+			if (program->binaryRequested)
 			{
-				if (name != nullptr)
-				{
-					//if the shader doesn't already exist the add it. else ignore it
-					if (shaders.find(name) == shaders.end())
-					{
-						shader_t* newShader = new shader_t(name, buffer, shaderType);
-						if (newShader->isCompiled)
-						{
-							shaders.insert(std::make_pair(name, std::move(newShader)));
-						}
-						return error_t::success;
-					}
-					return error_t::shaderAlreadyExists;
-				}
-				return error_t::invalidShaderName;
+				pendingBinaries.push_back(program.get());
 			}
-			return error_t::invalidBuffer;
+			return shaderPrograms.insert(std::make_pair(programName, std::move(program))).first;
 		}
 
-		//not sure what to do with this for the time being. just gonna leave it
-		void SetShaderBlockParseEvent(parseBlocks_t shaderBlockParse)
+		/*
+		* a relinked program has new content, so file it under its new key
+		*/
+		void RekeyProgram(shaderProgram_t* program)
 		{
-			shaderBlocksEvent = shaderBlockParse;
-		}
+			auto previous = programsByContent.find(program->contentKey);
+			if (previous == programsByContent.end() || previous->second.get() != program)
+			{
+				return;
+			}
 
-	private:
+			std::shared_ptr<shaderProgram_t> shared = previous->second;
+			programsByContent.erase(previous);
+			program->contentKey = program->MakeContentKey();
+			programsByContent.insert(std::make_pair(program->contentKey, shared));
+		}
 
 		/*
-		* convert the given string to a shader type
+		* delete every cached pipeline that uses the given stage handle. used when a stage is relinked
 		*/
-		GLuint StringToShaderType(const GLchar* typeString) const
+		void ForgetPipelines(GLuint stageHandle)
 		{
-			if (typeString != nullptr)
+			for (auto iter = pipelines.begin(); iter != pipelines.end();)
 			{
-				if (!strcmp(typeString, "Vertex"))
-				{
-					return gl_vertex_shader;
-				}
-
-				if (!strcmp(typeString, "Fragment"))
+				if (std::find(iter->first.begin(), iter->first.end(), stageHandle) == iter->first.end())
 				{
-					return gl_fragment_shader;
+					++iter;
+					continue;
 				}
 
-				if (!strcmp(typeString, "Geometry"))
+				for (auto bound = boundPipelines.begin(); bound != boundPipelines.end(); bound++)
 				{
-					return gl_geometry_shader;
+					bound->second = (bound->second == iter->second) ? 0 : bound->second;
 				}
+				glDeleteProgramPipelines(1, &iter->second);
+				iter = pipelines.erase(iter);
+			}
+		}
 
-				if (!strcmp(typeString, "Tessellation Control"))
-				{
-					return gl_tess_control_shader;
-				}
+		/*
+		* get the pipeline stage bit of a shader type
+		*/
+		static GLbitfield ShaderTypeToStageBit(GLuint shaderType)
+		{
+			switch (shaderType)
+			{
+				case gl_vertex_shader:				return gl_vertex_shader_bit;
+				case gl_fragment_shader:			return gl_fragment_shader_bit;
+				case gl_geometry_shader:			return gl_geometry_shader_bit;
+				case gl_tess_control_shader:		return gl_tess_control_shader_bit;
+				case gl_tess_evaluation_shader:		return gl_tess_evaluation_shader_bit;
+				default:							return 0;
+			}
+		}
 
-				if (!strcmp(typeString, "Tessellation Evaluation"))
+		/*
+		* start watching the files of every shader that isn't watched yet
+		*/
+		void WatchShaderFiles()
+		{
+			for (auto iter = shaders.begin(); iter != shaders.end(); iter++)
+			{
+				if (iter->second != nullptr && iter->second->filePath != NULL)
 				{
-					return gl_tess_evaluation_shader;
+					WatchShader(*iter->second, false);
 				}
-
-				return GL_FALSE;
 			}
-			return GL_FALSE;
 		}
 
 		/*
-		* convert the given shader type to a string
+		* record which files a shader is built from so a change to any of them finds the shader.
+		* refresh replaces what was recorded before, since an edit can add or remove includes.
+		* does nothing while hot reload is off; EnableHotReload picks up the shaders loaded before it
 		*/
-		const GLchar* ShaderTypeToString(GLuint shaderType) const
+		void WatchShader(const shader_t& shader, bool refresh)
 		{
-			switch (shaderType)
-			{
-			case gl_vertex_shader:
+			if (fileWatcher == nullptr || shader.filePath == NULL)
 			{
-				return "Vertex";
+				return;
 			}
 
-			case gl_fragment_shader:
+			std::vector<std::string> files(1, NormalizePath(shader.filePath));
+			for (size_t iterator = 0; iterator < shader.chunks.size(); iterator++)
 			{
-				return "Fragment";
+				files.push_back(NormalizePath(shader.chunks[iterator].filePath));
 			}
 
-			case gl_geometry_shader:
 			{
-				return "Geometry";
+				std::lock_guard<std::mutex> lock(reloadMutex);
+				if (!shaderRoots.insert(std::make_pair(shader.name, shader.filePath)).second && !refresh)
+				{
+					return;
+				}
+
+				for (auto iter = fileDependents.begin(); iter != fileDependents.end(); iter++)
+				{
+					iter->second.erase(shader.name);
+				}
+
+				for (size_t iterator = 0; iterator < files.size(); iterator++)
+				{
+					fileDependents[files[iterator]].insert(shader.name);
+				}
 			}
 
-			case gl_tess_control_shader:
+			for (size_t iterator = 0; iterator < files.size(); iterator++)
 			{
-				return "Tessellation Control";
+				fileWatcher->Watch(files[iterator]);
 			}
+		}
 
-			case gl_tess_evaluation_shader:
+		/*
+		* runs on the watcher thread. read the source of every shader that depends on the changed file again
+		* and queue it up for UpdateHotReload
+		*/
+		void ReadChangedFile(const std::string& filePath)
+		{
+			std::vector<std::pair<std::string, std::string>> affected;
 			{
-				return "Tessellation Evaluation";
+				std::lock_guard<std::mutex> lock(reloadMutex);
+				auto dependents = fileDependents.find(filePath);
+				if (dependents == fileDependents.end())
+				{
+					return;
+				}
+
+				for (auto iter = dependents->second.begin(); iter != dependents->second.end(); iter++)
+				{
+					affected.push_back(std::make_pair(*iter, shaderRoots[*iter]));
+				}
 			}
 
-			default:
+			for (size_t iterator = 0; iterator < affected.size(); iterator++)
 			{
-				return NULL;
-			}
-			}
+				reloadedSource_t reloaded;
+				reloaded.shaderName = affected[iterator].first;
+				reloaded.result = shader_t().ResolveIncludes(affected[iterator].second.c_str(), reloaded.source, reloaded.chunks);
 
-			return nullptr;
+				std::lock_guard<std::mutex> lock(reloadMutex);
+				reloadedSources.push_back(std::move(reloaded));
+			}
 		}
 
 		parseBlocks_t									shaderBlocksEvent;
+		programReady_t									programReadyEvent;		/**< Gets every program loaded from a config file as it links*/
+		programPriority_t								defaultPriority;		/**< The priority of programs the config file and SetProgramPriority say nothing about*/
+		std::map<std::string, programPriority_t>		programPriorities;		/**< Priorities set with SetProgramPriority, keyed by program name*/
+		std::list<std::shared_ptr<loadJob_t>>			loadJobs;				/**< Load jobs waiting for UpdateLoading, in the order they were started*/
+		std::set<std::string>							shaderFilePaths;		/**< The paths of shaders loaded from config files, which the shaders point at*/
+		bool											memoryLean;
+		const void*										currentContext;			/**< The context key from SetCurrentContext. nullptr to use the native context*/
+		std::map<const void*, GLuint>					boundPrograms;
+		std::map<const void*, GLuint>					boundPipelines;
+		std::map<std::string, std::unique_ptr<shaderProgram_t>>		separableStages;	/**< Shaders linked on their own for program pipelines, keyed by shader name*/
+		std::map<std::vector<GLuint>, GLuint>			pipelines;				/**< Program pipelines keyed by the sorted handles of their stages*/
+		std::map<GLuint64, std::shared_ptr<shaderProgram_t>>		programsByContent;	/**< Every program built from shaders, keyed by content so identical programs are linked once*/
+		std::mutex										reloadMutex;			/**< Guards everything below that the watcher thread touches*/
+		std::map<std::string, std::set<std::string>>	fileDependents;			/**< Every watched file and the names of the shaders built from it*/
+		std::map<std::string, std::string>				shaderRoots;			/**< The file each watched shader starts from*/
+		std::vector<reloadedSource_t>					reloadedSources;		/**< Sources read by the watcher thread, waiting for UpdateHotReload*/
+		std::set<shader_t*>								compilingShaders;		/**< Reloaded shaders whose new version is still compiling*/
+		std::set<shaderProgram_t*>						waitingPrograms;		/**< Programs to relink once their shaders are done compiling*/
+		std::set<shaderProgram_t*>						linkingPrograms;		/**< Programs whose new version is still linking*/
+		std::vector<shaderProgram_t*>					pendingBinaries;		/**< Linked programs whose binaries haven't been fetched for writing yet*/
+		binaryCache_t									binaryCache;			/**< The index of the binaries on disk. declared before the writer, whose thread uses it*/
+		binaryWriter_t									binaryWriter;			/**< Writes program binaries in the background*/
+		std::unique_ptr<fileWatcher_t>					fileWatcher;			/**< Declared last so its thread stops before the members it uses go away*/
 	};
 }
 #endif
@@ -0,0 +1,77 @@
+//tscook bakes a TinyShaders config file into a cooked manifest that shaderManager::LoadCookedManifest loads in one step
+#include <TinyExtender.h>
+using namespace TinyExtender;
+#define TS_HEADLESS
+#include "TinyShaders.h"
+
+using namespace TinyShaders;
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("usage: tscook <config file> <cooked manifest>\n");
+		return 1;
+	}
+
+	//the number of programs the config file declares
+	GLint numPrograms = 0;
+	FILE* configFile = fopen(argv[1], "r");
+	if (configFile == nullptr || fscanf(configFile, "%i", &numPrograms) != 1)
+	{
+		printf("tscook: could not read config file %s\n", argv[1]);
+		return 1;
+	}
+	fclose(configFile);
+
+	//a context is needed to validate that every program compiles and links. no display is needed for it
+	headlessContext_t context;
+	if (context.Initialize(TinyExtender::InitializeExtentions))
+	{
+		printf("tscook: could not create a headless OpenGL context\n");
+		return 1;
+	}
+
+	alwaysRetrievableBinaries = true;
+	shaderManager* shaders = new shaderManager();
+	std::vector<shaderProgram_t*> programs;
+
+	std::error_code result = shaders->LoadShaderProgramsFromConfigFile(argv[1], programs);
+	if (result)
+	{
+		printf("tscook: %s", result.message().c_str());
+		return 1;
+	}
+
+	for (size_t iterator = 0; iterator < programs.size(); iterator++)
+	{
+		printf("tscook: built %s\n", programs[iterator]->name);
+	}
+
+	//a program can still link with one of its shaders missing so any error fails the cook
+	GLint numErrors = PrintDiagnostics(shaders->diagnostics);
+
+	if (numErrors > 0)
+	{
+		printf("tscook: %i errors\n", numErrors);
+		return 1;
+	}
+
+	if ((GLint)programs.size() != numPrograms)
+	{
+		printf("tscook: %i of %i programs failed to build\n", numPrograms - (GLint)programs.size(), numPrograms);
+		return 1;
+	}
+
+	result = shaders->SaveCookedManifest(argv[2]);
+	if (result)
+	{
+		printf("tscook: %s", result.message().c_str());
+		return 1;
+	}
+
+	printf("tscook: wrote %s\n", argv[2]);
+	shaders->Shutdown();
+	context.Shutdown();
+	return 0;
+}
@@ -0,0 +1,55 @@
+//tsgen writes a C++ header with std140/std430 matching structs for every uniform and storage block in a TinyShaders config file
+#include <TinyExtender.h>
+using namespace TinyExtender;
+#define TS_HEADLESS
+#include "TinyShaders.h"
+
+using namespace TinyShaders;
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("usage: tsgen <config file> <header file>\n");
+		return 1;
+	}
+
+	//the layouts come from the driver so a context is needed to link the programs
+	headlessContext_t context;
+	if (context.Initialize(TinyExtender::InitializeExtentions))
+	{
+		printf("tsgen: could not create a headless OpenGL context\n");
+		return 1;
+	}
+
+	shaderManager* shaders = new shaderManager();
+	std::vector<shaderProgram_t*> programs;
+
+	std::error_code result = shaders->LoadShaderProgramsFromConfigFile(argv[1], programs);
+	if (result)
+	{
+		printf("tsgen: %s", result.message().c_str());
+		return 1;
+	}
+
+	//a block missing from a program that failed to link would silently drop its struct
+	GLint numErrors = PrintDiagnostics(shaders->diagnostics);
+
+	if (numErrors > 0)
+	{
+		printf("tsgen: %i errors\n", numErrors);
+		return 1;
+	}
+
+	result = shaders->SaveBlockHeader(argv[2], argv[1]);
+	if (result)
+	{
+		printf("tsgen: %s", result.message().c_str());
+		return 1;
+	}
+
+	printf("tsgen: wrote %i blocks to %s\n", (GLint)shaders->blockLayouts.size(), argv[2]);
+	shaders->Shutdown();
+	context.Shutdown();
+	return 0;
+}
@@ -0,0 +1,131 @@
+#tinyshaders_embed(<target> <manifest> [extra files...])
+#compiles a TinyShaders config file, every file it names and everything those files #include into the target as
+#constexpr byte arrays. shaderManager finds them before the file system, so an embedded build loads its shaders
+#without opening a single file. paths are relative to the directory the executable runs from, which defaults to
+#CMAKE_CURRENT_SOURCE_DIR. set TINYSHADERS_EMBED_BASE_DIR to change it.
+#extra files (Binaries.txt, cooked manifests, etc.) are embedded too and scanned for paths if they end in .txt
+
+set(TINYSHADERS_EMBED_SCRIPT "${CMAKE_CURRENT_LIST_FILE}")
+
+#turn a file path into the key the runtime looks it up by
+function(_tinyshaders_embed_key baseDir path outKey)
+	get_filename_component(absolutePath "${path}" ABSOLUTE BASE_DIR "${baseDir}")
+	file(RELATIVE_PATH relativePath "${baseDir}" "${absolutePath}")
+	if (relativePath MATCHES "^\\.\\./")
+		set(relativePath "${absolutePath}")
+	endif()
+	set(${outKey} "${relativePath}" PARENT_SCOPE)
+endfunction()
+
+#work out every file that has to be embedded
+function(_tinyshaders_embed_collect baseDir roots outFiles)
+	set(files "")
+	set(pending ${roots})
+	while (pending)
+		list(GET pending 0 key)
+		list(REMOVE_AT pending 0)
+		list(FIND files "${key}" found)
+		if (found EQUAL -1)
+			list(APPEND files "${key}")
+			get_filename_component(filePath "${key}" ABSOLUTE BASE_DIR "${baseDir}")
+			get_filename_component(fileDirectory "${key}" DIRECTORY)
+
+			if (key MATCHES "\\.txt$")
+				#config files name their shaders one per line
+				file(STRINGS "${filePath}" lines)
+				foreach (line ${lines})
+					string(REGEX MATCHALL "[^ \t]+" tokens "${line}")
+					foreach (token ${tokens})
+						get_filename_component(tokenPath "${token}" ABSOLUTE BASE_DIR "${baseDir}")
+						if (EXISTS "${tokenPath}" AND NOT IS_DIRECTORY "${tokenPath}")
+							_tinyshaders_embed_key("${baseDir}" "${token}" tokenKey)
+							list(APPEND pending "${tokenKey}")
+						endif()
+					endforeach()
+				endforeach()
+
+			elseif (NOT key MATCHES "\\.(glbin|spv|tscooked)$")
+				#includes are relative to the including file, the same way shader_t resolves them
+				file(STRINGS "${filePath}" includes REGEX "^[ \t]*#include[ \t]*\"[^\"]+\"")
+				foreach (include ${includes})
+					string(REGEX REPLACE "^[ \t]*#include[ \t]*\"([^\"]+)\".*$" "\\1" includePath "${include}")
+					if (fileDirectory)
+						set(includePath "${fileDirectory}/${includePath}")
+					endif()
+					_tinyshaders_embed_key("${baseDir}" "${includePath}" includeKey)
+					list(APPEND pending "${includeKey}")
+				endforeach()
+			endif()
+		endif()
+	endwhile()
+	set(${outFiles} ${files} PARENT_SCOPE)
+endfunction()
+
+if (CMAKE_SCRIPT_MODE_FILE)
+	#script mode: write the generated source. called from the custom command below
+	string(REPLACE "|" ";" roots "${ROOTS}")
+	_tinyshaders_embed_collect("${BASE_DIR}" "${roots}" files)
+
+	set(source "//generated by tinyshaders_embed. do not edit\n#include <cstddef>\n\n")
+	set(source "${source}namespace TinyShaders\n{\n\tstruct embeddedFile_t\n\t{\n\t\tconst char*\t\t\t\tpath;\n\t\tconst unsigned char*\tdata;\n\t\tsize_t\t\t\t\t\tsize;\n\t};\n\n")
+	set(table "")
+	set(index 0)
+	#cmake regexes have no {n} so spell out a line of 32 bytes
+	set(lineOfBytes "")
+	foreach (byte RANGE 31)
+		set(lineOfBytes "${lineOfBytes}0x..,")
+	endforeach()
+	foreach (key ${files})
+		get_filename_component(filePath "${key}" ABSOLUTE BASE_DIR "${BASE_DIR}")
+		file(READ "${filePath}" contents HEX)
+		string(LENGTH "${contents}" hexLength)
+		math(EXPR size "${hexLength} / 2")
+		#a trailing zero byte keeps empty files legal and text files terminated
+		string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," contents "${contents}")
+		string(REGEX REPLACE "(${lineOfBytes})" "\\1\n\t\t" contents "${contents}")
+		set(source "${source}\tstatic constexpr unsigned char embeddedData${index}[] =\n\t{\n\t\t${contents}0x00\n\t};\n\n")
+		set(table "${table}\t\t{ \"${key}\", embeddedData${index}, ${size} },\n")
+		math(EXPR index "${index} + 1")
+	endforeach()
+
+	set(source "${source}\textern const embeddedFile_t ${TABLE}[];\n\tconst embeddedFile_t ${TABLE}[] =\n\t{\n${table}\t\t{ nullptr, nullptr, 0 }\n\t};\n}\n")
+	file(WRITE "${OUTPUT}.tmp" "${source}")
+	execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+	file(REMOVE "${OUTPUT}.tmp")
+	return()
+endif()
+
+function(tinyshaders_embed target manifest)
+	if (TINYSHADERS_EMBED_BASE_DIR)
+		set(baseDir "${TINYSHADERS_EMBED_BASE_DIR}")
+	else()
+		set(baseDir "${CMAKE_CURRENT_SOURCE_DIR}")
+	endif()
+
+	set(roots "")
+	foreach (root ${manifest} ${ARGN})
+		_tinyshaders_embed_key("${baseDir}" "${root}" rootKey)
+		list(APPEND roots "${rootKey}")
+	endforeach()
+
+	#the file list is worked out at configure time for the dependencies. adding a new #include needs a re-run of cmake
+	_tinyshaders_embed_collect("${baseDir}" "${roots}" files)
+	set(dependencies "")
+	foreach (key ${files})
+		get_filename_component(filePath "${key}" ABSOLUTE BASE_DIR "${baseDir}")
+		list(APPEND dependencies "${filePath}")
+	endforeach()
+
+	string(MAKE_C_IDENTIFIER "TinyShadersEmbedded_${target}" table)
+	string(REPLACE ";" "|" rootsArgument "${roots}")
+	set(output "${CMAKE_CURRENT_BINARY_DIR}/${target}_TinyShadersEmbedded.cpp")
+
+	add_custom_command(OUTPUT "${output}"
+		COMMAND ${CMAKE_COMMAND} "-DROOTS=${rootsArgument}" "-DBASE_DIR=${baseDir}" "-DOUTPUT=${output}" "-DTABLE=${table}" -P "${TINYSHADERS_EMBED_SCRIPT}"
+		DEPENDS ${dependencies} "${TINYSHADERS_EMBED_SCRIPT}"
+		COMMENT "Embedding TinyShaders files for ${target}"
+		VERBATIM)
+
+	target_sources(${target} PRIVATE "${output}")
+	target_compile_definitions(${target} PRIVATE "TS_EMBEDDED_TABLE=${table}")
+endfunction()